@@ -1,24 +1,58 @@
 /*
- * Allocates dummy objects and outputs the number of objects allocated so far
+ * Regression benchmark for container allocation in C2-compiled code.
+ *
+ * Allocates MyHashMap containers (and plain objects, which must not pay for the
+ * root registration) in a loop hot enough to be compiled by C2, keeping a sliding
+ * window of containers alive so that they are promoted into the bda-spaces.
+ * Each round prints the allocation rate; after warm-up it should stay flat.
+ *
+ * Run with: benchmark.sh -local -bda <ratio> MyHashMap TestOptoAllocation [rounds] [allocs]
  */
 public class TestOptoAllocation {
-  private static int count;
-  private static int max = 3000;
-  
+  private static int rounds = 20;
+  private static int allocs = 1000000;
+  private static final int window = 4096;
+
+  private static MyHashMap<Integer, Integer>[] live;
+  private static Object sink;
+  private static long count;
+
+  @SuppressWarnings("unchecked")
   public static void main(String[] args) throws Exception {
+    if (args.length > 0) rounds = Integer.parseInt(args[0]);
+    if (args.length > 1) allocs = Integer.parseInt(args[1]);
+    live = new MyHashMap[window];
     count = 0;
 
-    for (int i = 0; i < max; i++) {
-      Object o = allocate();
+    for (int r = 0; r < rounds; r++) {
+      long start = System.nanoTime();
+      allocate(r);
+      long elapsed = System.nanoTime() - start;
+      System.out.println("Round " + r + ": " + allocs + " containers in "
+                         + (elapsed / 1000000) + " ms ("
+                         + (allocs * 1000L / Math.max(elapsed / 1000, 1)) + " allocs/ms)");
     }
 
+    // Every container still in the window must be intact.
+    for (int i = 0; i < window; i++) {
+      if (live[i] != null && live[i].get(i) != null && live[i].get(i) != i) {
+        throw new RuntimeException("Corrupted container at " + i);
+      }
+    }
+
+    System.out.println("Allocated " + count + " containers");
     System.out.println("---------- TestOptoAllocation DONE ----------");
   }
 
-  /* Alocates dummy objects */
-  private static Object allocate() {
-    Object o = new Object();
-    System.out.println("Allocated object #" + ++count + " " + o);
-    return o;
+  /* Allocates containers, and dummy objects, in a compiled loop */
+  private static void allocate(int color) {
+    for (int i = 0; i < allocs; i++) {
+      MyHashMap<Integer, Integer> m = new MyHashMap<Integer, Integer>(4, color);
+      int slot = i & (window - 1);
+      m.put(slot, slot);
+      live[slot] = m;
+      sink = new Object();
+      count++;
+    }
   }
 }
@@ -1640,6 +1640,17 @@ void LIR_Assembler::emit_alloc_obj(LIR_OpAllocObj* op) {
                      op->object_size(),
                      op->klass()->as_register(),
                      *op->stub()->entry());
+#if defined(BDA) || defined(BDA_INTERPRETER)
+  // Only the fast path registers the container here. The stub registers it
+  // itself, either inline or in the runtime (see Runtime1::new_instance).
+  if (op->bda_region() != NULL) {
+    Register region = op->tmp1()->as_register();
+    Register thread = NOT_LP64(op->tmp3()->as_register()) LP64_ONLY(r15_thread);
+    NOT_LP64(__ get_thread(thread));
+    __ movptr(region, (intptr_t)op->bda_region());
+    __ bda_enqueue_root(op->obj()->as_register(), region, thread, op->tmp2()->as_register());
+  }
+#endif
   __ bind(*op->stub()->continuation());
 }
 
@@ -34,6 +34,9 @@
 #include "runtime/biasedLocking.hpp"
 #include "runtime/os.hpp"
 #include "runtime/stubRoutines.hpp"
+#if defined(BDA) || defined(BDA_INTERPRETER)
+#include "bda/bdaRootBuffer.hpp"
+#endif
 
 int C1_MacroAssembler::lock_object(Register hdr, Register obj, Register disp_hdr, Register scratch, Label& slow_case) {
   const int aligned_mask = BytesPerWord -1;
@@ -243,6 +246,33 @@ void C1_MacroAssembler::allocate_object(Register obj, Register t1, Register t2,
   initialize_object(obj, klass, noreg, object_size * HeapWordSize, t1, t2);
 }
 
+#if defined(BDA) || defined(BDA_INTERPRETER)
+void C1_MacroAssembler::bda_enqueue_root(Register obj, Register region, Register thread, Register t1) {
+  assert(obj == rax, "obj must be in rax, for the runtime stub");
+  assert_different_registers(obj, region, thread, t1);
+  Label buffer_full, done;
+
+  // Same as the interpreter (see TemplateTable::_new): log [obj, region] while
+  // there is room in the buffer, otherwise let the runtime allocate or flush it.
+  movptr(t1, Address(thread, JavaThread::bda_root_buffer_index_offset()));
+  testptr(t1, t1);
+  jcc(Assembler::zero, buffer_full);
+  subptr(t1, BDARootBuffer::entry_size_in_bytes());
+  movptr(Address(thread, JavaThread::bda_root_buffer_index_offset()), t1);
+  addptr(t1, Address(thread, JavaThread::bda_root_buffer_buf_offset()));
+  movptr(Address(t1, 0), obj);
+  movptr(Address(t1, wordSize), region);
+  jmp(done);
+
+  bind(buffer_full);
+  push(region);
+  call(RuntimeAddress(Runtime1::entry_for(Runtime1::bda_enqueue_root_id)));
+  pop(region);
+
+  bind(done);
+}
+#endif // BDA || BDA_INTERPRETER
+
 void C1_MacroAssembler::initialize_object(Register obj, Register klass, Register var_size_in_bytes, int con_size_in_bytes, Register t1, Register t2) {
   assert((con_size_in_bytes & MinObjAlignmentInBytesMask) == 0,
          "con_size_in_bytes is not multiple of alignment");
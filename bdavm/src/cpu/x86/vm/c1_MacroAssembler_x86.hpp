@@ -78,6 +78,15 @@
   // slow_case  : exit to slow case implementation if fast allocation fails
   void allocate_object(Register obj, Register t1, Register t2, int header_size, int object_size, Register klass, Label& slow_case);
 
+#if defined(BDA) || defined(BDA_INTERPRETER)
+  // logging of a newly allocated container in the thread's BDARootBuffer
+  // obj        : must be rax, contents preserved
+  // region     : the BDARegion* of the container's klass, contents preserved
+  // thread     : the current thread, contents preserved
+  // t1         : scratch register - contents destroyed
+  void bda_enqueue_root(Register obj, Register region, Register thread, Register t1);
+#endif
+
   enum {
     max_array_allocation_length = 0x00FFFFFF
   };
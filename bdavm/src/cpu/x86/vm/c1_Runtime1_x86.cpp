@@ -36,6 +36,9 @@
 #include "runtime/sharedRuntime.hpp"
 #include "runtime/signature.hpp"
 #include "runtime/vframeArray.hpp"
+#if defined(BDA) || defined(BDA_INTERPRETER)
+#include "gc_interface/collectedHeap.hpp"
+#endif
 #include "utilities/macros.hpp"
 #include "vmreg_x86.inline.hpp"
 #if INCLUDE_ALL_GCS
@@ -967,6 +970,21 @@ OopMapSet* Runtime1::generate_patching(StubAssembler* sasm, address target) {
   return oop_maps;
 }
 
+#if defined(BDA) || defined(BDA_INTERPRETER)
+// Registers a container allocated by the fast_new_instance stubs, whose klass
+// is only known at run time. t1 and t2 are destroyed.
+static void bda_enqueue_root_if_needed(StubAssembler* sasm, Register obj, Register klass,
+                                       Register thread, Register t1, Register t2) {
+  if (!UseBDA) return;
+  Label not_bda;
+  __ movptr(t1, Address(klass, Klass::bda_region_offset()));
+  __ testptr(t1, t1);
+  __ jcc(Assembler::zero, not_bda);
+  __ bda_enqueue_root(obj, t1, thread, t2);
+  __ bind(not_bda);
+}
+#endif // BDA || BDA_INTERPRETER
+
 
 OopMapSet* Runtime1::generate_code_for(StubID id, StubAssembler* sasm) {
 
@@ -1052,6 +1070,9 @@ OopMapSet* Runtime1::generate_code_for(StubID id, StubAssembler* sasm) {
 
           __ initialize_object(obj, klass, obj_size, 0, t1, t2);
           __ verify_oop(obj);
+#if defined(BDA) || defined(BDA_INTERPRETER)
+          bda_enqueue_root_if_needed(sasm, obj, klass, thread, t1, t2);
+#endif
           __ pop(rbx);
           __ pop(rdi);
           __ ret(0);
@@ -1065,6 +1086,9 @@ OopMapSet* Runtime1::generate_code_for(StubID id, StubAssembler* sasm) {
 
           __ initialize_object(obj, klass, obj_size, 0, t1, t2);
           __ verify_oop(obj);
+#if defined(BDA) || defined(BDA_INTERPRETER)
+          bda_enqueue_root_if_needed(sasm, obj, klass, thread, t1, t2);
+#endif
           __ pop(rbx);
           __ pop(rdi);
           __ ret(0);
@@ -1514,6 +1538,25 @@ OopMapSet* Runtime1::generate_code_for(StubID id, StubAssembler* sasm) {
       }
       break;
 
+#if defined(BDA) || defined(BDA_INTERPRETER)
+    case bda_enqueue_root_id:
+      { // rax,: object
+        // arg0: BDARegion* of the object's klass
+        StubFrame f(sasm, "bda_enqueue_root", dont_gc_arguments);
+        // we can't gc here so skip the oopmap but make sure that all
+        // the live registers get saved.
+        save_live_registers(sasm, 3);
+
+        const Register thread = NOT_LP64(rdi) LP64_ONLY(r15_thread);
+        NOT_LP64(__ get_thread(thread));
+        f.load_argument(0, rbx);
+        __ call_VM_leaf(CAST_FROM_FN_PTR(address, CollectedHeap::enqueue_asm), thread, rax, rbx);
+
+        restore_live_registers(sasm);
+      }
+      break;
+#endif // BDA || BDA_INTERPRETER
+
     case fpu2long_stub_id:
       {
         // rax, and rdx are destroyed, but should be free since the result is returned there
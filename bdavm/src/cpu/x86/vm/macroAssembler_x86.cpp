@@ -4358,6 +4358,30 @@ void MacroAssembler::store_check_part_2(Register obj) {
     Address index(noreg, obj, Address::times_1);
     movb(as_Address(ArrayAddress(cardtable, index)), 0);
   }
+#ifdef BDA
+  if (ct->bda_summary_base != NULL) {
+    // Dirty the bda summary entry of the card as well (see cardTableModRefBS.hpp).
+    // Only store if the entry is not dirty yet, to avoid sharing its cache line
+    // between the threads storing to the same slot.
+    Label L_already_dirty;
+    shrptr(obj, CardTableModRefBS::bda_summary_shift - CardTableModRefBS::card_shift);
+    intptr_t summary_disp = (intptr_t) ct->bda_summary_base;
+    if (is_simm32(summary_disp)) {
+      Address summary(noreg, obj, Address::times_1, summary_disp);
+      cmpb(summary, 0);
+      jccb(Assembler::equal, L_already_dirty);
+      movb(summary, 0);
+    } else {
+      AddressLiteral summary_base((address)ct->bda_summary_base, relocInfo::none);
+      Address index(noreg, obj, Address::times_1);
+      Address summary = as_Address(ArrayAddress(summary_base, index));
+      cmpb(summary, 0);
+      jccb(Assembler::equal, L_already_dirty);
+      movb(summary, 0);
+    }
+    bind(L_already_dirty);
+  }
+#endif // BDA
 }
 
 void MacroAssembler::subptr(Register dst, int32_t imm32) {
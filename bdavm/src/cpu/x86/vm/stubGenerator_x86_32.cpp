@@ -763,6 +763,26 @@ class StubGenerator: public StubCodeGenerator {
           __ shrptr(start, CardTableModRefBS::card_shift);
           __ shrptr(end,   CardTableModRefBS::card_shift);
           __ subptr(end, start); // end --> count
+#ifdef BDA
+          if (ct->bda_summary_base != NULL) {
+            // Dirty the bda summary entries of the cards (see cardTableModRefBS.hpp)
+            Label L_summary_loop;
+            const int summary_shift = CardTableModRefBS::bda_summary_shift - CardTableModRefBS::card_shift;
+            __ push(start);
+            __ push(end);
+            __ addptr(end, start); // end --> last card
+            __ shrptr(start, summary_shift);
+            __ shrptr(end,   summary_shift);
+            __ subptr(end, start); // end --> summary entries count
+          __ BIND(L_summary_loop);
+            Address summary(start, end, Address::times_1, (intptr_t) ct->bda_summary_base);
+            __ movb(summary, 0);
+            __ decrement(end);
+            __ jcc(Assembler::greaterEqual, L_summary_loop);
+            __ pop(end);
+            __ pop(start);
+          }
+#endif // BDA
         __ BIND(L_loop);
           intptr_t disp = (intptr_t) ct->byte_map_base;
           Address cardtable(start, count, Address::times_1, disp);
@@ -1257,6 +1257,27 @@ class StubGenerator: public StubCodeGenerator {
           __ shrptr(start, CardTableModRefBS::card_shift);
           __ shrptr(end,   CardTableModRefBS::card_shift);
           __ subptr(end, start); // end --> cards count
+#ifdef BDA
+          if (ct->bda_summary_base != NULL) {
+            // Dirty the bda summary entries of the cards (see cardTableModRefBS.hpp)
+            Label L_summary_loop;
+            const int summary_shift = CardTableModRefBS::bda_summary_shift - CardTableModRefBS::card_shift;
+            __ push(start);
+            __ push(end);
+            __ addptr(end, start); // end --> last card
+            __ shrptr(start, summary_shift);
+            __ shrptr(end,   summary_shift);
+            __ subptr(end, start); // end --> summary entries count
+            __ mov64(scratch, (int64_t) ct->bda_summary_base);
+            __ addptr(start, scratch);
+          __ BIND(L_summary_loop);
+            __ movb(Address(start, end, Address::times_1), 0);
+            __ decrement(end);
+            __ jcc(Assembler::greaterEqual, L_summary_loop);
+            __ pop(end);
+            __ pop(start);
+          }
+#endif // BDA
 
           int64_t disp = (int64_t) ct->byte_map_base;
           __ mov64(scratch, disp);
@@ -38,7 +38,8 @@
 #include "utilities/macros.hpp"
 
 #if defined(BDA) || defined(BDA_INTERPRETER)
-# include "oops/klassRegionMap.hpp"
+# include "bda/bdaRootBuffer.hpp"
+# include "gc_interface/collectedHeap.hpp"
 #endif // BDA || BDA_INTERPRETER
 
 #ifndef CC_INTERP
@@ -3258,6 +3259,17 @@ void TemplateTable::_new() {
   Label initialize_object; // including clearing the fields
   Label allocate_shared;
 
+#if defined(BDA) || defined(BDA_INTERPRETER)
+  if (UseBDA && KlassRegionMap::has_alloc_sites()) {
+    // Methods with bda allocation sites allocate in the runtime, which looks
+    // up the region of the site (see InterpreterRuntime::_new).
+    __ get_method(rcx);
+    __ movptr(rcx, Address(rcx, Method::bda_sites_offset()));
+    __ testptr(rcx, rcx);
+    __ jcc(Assembler::notZero, slow_case);
+  }
+#endif // BDA || BDA_INTERPRETER
+
   __ get_cpool_and_tags(rsi, rax);
   // Make sure the class we're about to instantiate has been resolved.
   // This is done before loading InstanceKlass to be consistent with the order
@@ -3375,30 +3387,9 @@ void TemplateTable::_new() {
     // initialize object header only.
     __ bind(initialize_header);
 #if defined(BDA) || defined(BDA_INTERPRETER)
-    // Test if it is a valid BDA value
-    // Must be done here after having the object allocated but before rsi
-    // is consumed when storing the klass field
-    Label done_enqueue;
-    // Save registers
-    __ push (rsi);
-    __ push (rdx);
-    __ push (rax);
-
-    // Call the VM to search the BDARegion ptr
-    call_VM (c_rarg2, CAST_FROM_FN_PTR(address, KlassRegionMap::is_bda_klass_asm), rsi);
-    __ testptr (c_rarg2, c_rarg2);
-    __ jcc (Assembler::zero, done_enqueue);
-
-    // If it hit add the ref to the refqueue
-    __ lea (c_rarg1, Address(rsp,0)); // get the oop address (don't forget to dereference)
-    call_VM (rax, CAST_FROM_FN_PTR(address, CollectedHeap::enqueue_asm),
-             c_rarg1, c_rarg2);
-
-    // Pop the saved registers
-    __ bind (done_enqueue);
-    __ pop (rax);
-    __ pop (rdx);
-    __ pop (rsi);
+    // Load the bda-space cached in the klass (NULL for non-bda klasses).
+    // Must be done here, before rsi is consumed when storing the klass field.
+    __ movptr(rbx, Address(rsi, Klass::bda_region_offset()));
 #endif // BDA || BDA_INTERPRETER
     if (UseBiasedLocking) {
       __ movptr(rscratch1, Address(rsi, Klass::prototype_header_offset()));
@@ -3411,7 +3402,36 @@ void TemplateTable::_new() {
     __ store_klass_gap(rax, rcx);  // zero klass gap for compressed oops
     __ store_klass(rax, rsi);      // store klass last
 
-    
+#if defined(BDA) || defined(BDA_INTERPRETER)
+    {
+      // Log the new object as a bda root in the thread's buffer.
+      // rax: object, rbx: bda-space or NULL
+      Label done_enqueue, buffer_full;
+      __ testptr(rbx, rbx);
+      __ jcc(Assembler::zero, done_enqueue);
+
+      __ movptr(rcx, Address(r15_thread, in_bytes(JavaThread::bda_root_buffer_index_offset())));
+      __ testptr(rcx, rcx);
+      __ jcc(Assembler::zero, buffer_full);
+      __ subptr(rcx, BDARootBuffer::entry_size_in_bytes());
+      __ movptr(Address(r15_thread, in_bytes(JavaThread::bda_root_buffer_index_offset())), rcx);
+      __ addptr(rcx, Address(r15_thread, in_bytes(JavaThread::bda_root_buffer_buf_offset())));
+      __ movptr(Address(rcx, 0), rax);
+      __ movptr(Address(rcx, wordSize), rbx);
+      __ jmp(done_enqueue);
+
+      // The buffer is full (or not yet allocated). The object is already parsable,
+      // and the leaf call cannot safepoint, so rax only needs to be preserved.
+      __ bind(buffer_full);
+      __ push(atos);
+      __ call_VM_leaf(CAST_FROM_FN_PTR(address, CollectedHeap::enqueue_asm),
+                      r15_thread, rax, rbx);
+      __ pop(atos);
+
+      __ bind(done_enqueue);
+    }
+#endif // BDA || BDA_INTERPRETER
+
     {
       SkipIfEqual skip(_masm, &DTraceAllocProbes, false);
       // Trigger dtrace event for fastpath
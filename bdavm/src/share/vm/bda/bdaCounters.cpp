@@ -0,0 +1,117 @@
+# include "bda/bdaCounters.hpp"
+# include "bda/refqueue.hpp"
+# include "gc_interface/collectedHeap.hpp"
+# include "memory/resourceArea.hpp"
+# include "memory/universe.hpp"
+
+#ifdef BDA
+BDASpaceCounters::BDASpaceCounters(const char * name_space, int ordinal,
+                                   MutableBDASpace::CGRPSpace * grp) :
+  _grp(grp), _name_space(NULL) {
+
+  if (UsePerfData) {
+    EXCEPTION_MARK;
+    ResourceMark rm;
+
+    const char * cns = PerfDataManager::name_space(name_space, "space", ordinal);
+    _name_space = NEW_C_HEAP_ARRAY(char, strlen(cns)+1, mtGC);
+    strcpy(_name_space, cns);
+
+    const char * cname = PerfDataManager::counter_name(_name_space, "capacity");
+    _capacity = PerfDataManager::create_variable(SUN_GC, cname, PerfData::U_Bytes,
+                                                 _grp->space()->capacity_in_bytes(), CHECK);
+
+    cname = PerfDataManager::counter_name(_name_space, "used");
+    _used = PerfDataManager::create_variable(SUN_GC, cname, PerfData::U_Bytes,
+                                             new CGRPSpaceUsedHelper(_grp), CHECK);
+
+    cname = PerfDataManager::counter_name(_name_space, "containers");
+    _containers = PerfDataManager::create_variable(SUN_GC, cname, PerfData::U_Events,
+                                                   (jlong)0, CHECK);
+
+    cname = PerfDataManager::counter_name(_name_space, "pooledSegments");
+    _pooled_segments = PerfDataManager::create_variable(SUN_GC, cname, PerfData::U_Events,
+                                                        (jlong)0, CHECK);
+
+    cname = PerfDataManager::counter_name(_name_space, "segmentSize");
+    _segment_size = PerfDataManager::create_variable(SUN_GC, cname, PerfData::U_Bytes,
+                                                     (jlong)(_grp->segment_size() * HeapWordSize),
+                                                     CHECK);
+
+    cname = PerfDataManager::counter_name(_name_space, "segments");
+    _segments = PerfDataManager::create_variable(SUN_GC, cname, PerfData::U_Events,
+                                                 (jlong)0, CHECK);
+
+    cname = PerfDataManager::counter_name(_name_space, "extensions");
+    _extensions = PerfDataManager::create_variable(SUN_GC, cname, PerfData::U_Events,
+                                                   (jlong)0, CHECK);
+
+    cname = PerfDataManager::counter_name(_name_space, "fragmentation");
+    _fragmentation = PerfDataManager::create_variable(SUN_GC, cname, PerfData::U_None,
+                                                      (jlong)0, CHECK);
+  }
+}
+
+void
+BDASpaceCounters::update_all()
+{
+  assert (UsePerfData, "Should not be called unless perf data is on");
+  _capacity->set_value(_grp->space()->capacity_in_bytes());
+  _containers->set_value(_grp->container_count());
+  _pooled_segments->set_value(_grp->pooled_count());
+  _segment_size->set_value(_grp->segment_size() * HeapWordSize);
+  _segments->set_value(_grp->segments_since_last_gc());
+  _extensions->set_value(_grp->extensions_since_last_gc());
+  _fragmentation->set_value((jlong)(_grp->container_fragmentation(NULL) * 1000000));
+}
+
+BDACounters::BDACounters(MutableBDASpace * manager) :
+  _space_counters(NULL), _n_spaces(0), _name_space(NULL) {
+
+  if (UsePerfData) {
+    EXCEPTION_MARK;
+    ResourceMark rm;
+
+    const char * cns = "bda";
+    _name_space = NEW_C_HEAP_ARRAY(char, strlen(cns)+1, mtGC);
+    strcpy(_name_space, cns);
+
+    const char * cname = PerfDataManager::counter_name(_name_space, "spaces");
+    PerfDataManager::create_constant(SUN_GC, cname, PerfData::U_None,
+                                     (jlong)manager->spaces()->length(), CHECK);
+
+    cname = PerfDataManager::counter_name(_name_space, "roots");
+    _roots = PerfDataManager::create_variable(SUN_GC, cname, PerfData::U_Events,
+                                              (jlong)0, CHECK);
+
+    _n_spaces = manager->spaces()->length();
+    _space_counters = NEW_C_HEAP_ARRAY(BDASpaceCounters*, _n_spaces, mtGC);
+    for (int i = 0; i < _n_spaces; ++i) {
+      _space_counters[i] = new BDASpaceCounters(_name_space, i, manager->spaces()->at(i));
+    }
+  }
+}
+
+BDACounters::~BDACounters()
+{
+  for (int i = 0; i < _n_spaces; ++i) {
+    delete _space_counters[i];
+  }
+  if (_space_counters != NULL) FREE_C_HEAP_ARRAY(BDASpaceCounters*, _space_counters, mtGC);
+  if (_name_space != NULL) FREE_C_HEAP_ARRAY(char, _name_space, mtGC);
+}
+
+void
+BDACounters::update_all()
+{
+  if (!UsePerfData) return;
+
+  RefQueue * refqueue = Universe::heap()->bda_refqueue();
+  if (refqueue != NULL) {
+    _roots->set_value(refqueue->roots_count());
+  }
+  for (int i = 0; i < _n_spaces; ++i) {
+    _space_counters[i]->update_all();
+  }
+}
+#endif // BDA
@@ -0,0 +1,83 @@
+#ifndef SHARE_VM_BDA_BDACOUNTERS_HPP
+#define SHARE_VM_BDA_BDACOUNTERS_HPP
+
+# include "bda/mutableBDASpace.hpp"
+# include "runtime/perfData.hpp"
+
+//
+// BDASpaceCounters are the perf counters of a bda-space, under sun.gc.bda.space.<i>,
+// where i is the index of the space in the MutableBDASpace (0 is the general object
+// space). The used words are sampled, the rest is updated at the end of each GC.
+//
+class BDASpaceCounters : public CHeapObj<mtGC> {
+  friend class VMStructs;
+
+ private:
+  PerfVariable *               _capacity;
+  PerfVariable *               _used;
+  PerfVariable *               _containers;
+  PerfVariable *               _pooled_segments;
+  PerfVariable *               _segment_size;
+  // Segments allocated (or taken from the pool) in the last GC, and how many of
+  // those extended an existing container
+  PerfVariable *               _segments;
+  PerfVariable *               _extensions;
+  // The mean fragmentation of the segments, in parts per million
+  PerfVariable *               _fragmentation;
+
+  MutableBDASpace::CGRPSpace * _grp;
+  char *                       _name_space;
+
+ public:
+
+  BDASpaceCounters(const char * name_space, int ordinal,
+                   MutableBDASpace::CGRPSpace * grp);
+
+  ~BDASpaceCounters() {
+    if (_name_space != NULL) FREE_C_HEAP_ARRAY(char, _name_space, mtGC);
+  }
+
+  // Called at the end of a GC, before the stats of the space are reset
+  void update_all();
+};
+
+//
+// BDACounters holds the perf counters of the bda-spaces and the ones of the whole
+// MutableBDASpace, under sun.gc.bda, so that jstat and the JMX clients can follow
+// the placement of the containers while the application runs.
+//
+class BDACounters : public CHeapObj<mtGC> {
+  friend class VMStructs;
+
+ private:
+  // Roots found in the refqueue by the last scavenge
+  PerfVariable *      _roots;
+  // Constant PerfData types don't need to retain a reference.
+  // PerfConstant *   _spaces;
+
+  BDASpaceCounters ** _space_counters;
+  int                 _n_spaces;
+  char *              _name_space;
+
+ public:
+
+  BDACounters(MutableBDASpace * manager);
+  ~BDACounters();
+
+  void update_all();
+};
+
+class CGRPSpaceUsedHelper : public PerfLongSampleHelper {
+ private:
+  MutableBDASpace::CGRPSpace * _grp;
+
+ public:
+  CGRPSpaceUsedHelper(MutableBDASpace::CGRPSpace * grp) : _grp(grp) { }
+
+  // The bytes taken by the segments of the space, which need no walk of the containers
+  inline jlong take_sample() {
+    return (jlong)(_grp->reserved_words() * HeapWordSize);
+  }
+};
+
+#endif // SHARE_VM_BDA_BDACOUNTERS_HPP
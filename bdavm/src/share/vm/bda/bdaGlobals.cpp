@@ -8,8 +8,8 @@ BDARegion*
 BDARegion::mask_out_element_ptr(BDARegion* v)
 {
   if(is_bad_region_ptr(v)) return KlassRegionMap::region_start_ptr();
-  int idx = log2_intptr((intptr_t)v->value());
-  if(is_odd((intptr_t)idx) && idx > 2)
+  // The container of an element is the entry before it in the _region_data array
+  if(v->get_bda_type() == element)
     return v - 1;
   return v;
 }
@@ -13,22 +13,32 @@ typedef struct container {
   HeapWord * _end;
   HeapWord * _hard_end; // This is the end of the segment without minus filler-header
   HeapWord * _saved_top; // For scavenge from old to young;
-  char       _space_id;
-#ifdef ASSERT
-  int8_t     _scanned_flag;
-#endif
+  uint16_t   _space_id;
+  int8_t     _numa_node; // The node its pages are biased to (see BDANUMAPlacement)
+  uint16_t   _chain_space_id; // The space of the first segment of its container
+  uint16_t   _chain_pos; // Position in the chain of segments of its container, from 1,
+                         // saturated at max_chain_pos
   struct container * _next_segment; // For partition of containers into small segments.
   struct container * _prev_segment; // Ease the iteration and removal of segments
   struct container * _next; // For iteration of containers in mutableSpaces
   struct container * _previous; // Serves both the container segments and the double link list
 } * container_t;
 
+// The chain positions saturate, since the histograms of the chain lengths put all the
+// chains longer than 64 segments in the same bucket (see BDAFragmentationStats).
+const uint16_t max_chain_pos = max_jushort;
+
 
 
 /*
  * BDARegion is a wrapper to a bdareg_t value. What it does is provide
  * methods to query the value and interpret the response, i.e., toString(),
  * etc.
+ * The value is the space id of the region shifted by region_shift, with the low bit
+ * set for the elements: the general object space (region_start) is space 0 and the
+ * k-th bda region is space k, with the containers in 2k and the elements in 2k+1.
+ * Thus the value is also the index of the region in KlassRegionMap::_region_data and
+ * the space id the index of its space in MutableBDASpace::spaces().
  */
 class BDARegion : public CHeapObj<mtGC> {
 
@@ -51,6 +61,8 @@ public:
   static const int       other_mask = 0x1;
   static const uintptr_t container_mask = (1UL << 63) - 2UL;
   static const uint      badheap_mask = (1L << 32) - 1L;
+  // The space ids are kept in the container descriptors in 16 bits
+  static const int       max_space_id = max_jushort;
 
   // This two values are for faster access to the limits of the
   // KlassRegionMap::_region_data array and to avoid circular dependencies (and their
@@ -96,12 +108,16 @@ public:
     }
   }
 
+  // The index of the space of the region, the same for its containers and elements
   int space_id() const {
-    return log2_intptr((intptr_t)value()) + 1;
+    return (int)(value() >> region_shift);
   }
   static int space_id(BDARegion* v) {
     if(is_bad_region_ptr(v)) return 0;
-    return log2_intptr((intptr_t)v->value()) + 1;
+    return v->space_id();
+  }
+  static bdareg_t container_of_space(int space_id) {
+    return space_id == 0 ? region_start : (bdareg_t)space_id << region_shift;
   }
 
   bool is_null_region() const {
@@ -123,27 +139,40 @@ public:
 
   template <class T> static void encode_oop_element(T* p, BDARegion* r);
 
-  // This method is still a bit insane...
+  // The kind of objects of the region, from its space id and element bit
   inline const char* toString()
     {
-      switch(value())
-      {
-      case other:
+      if (is_null_region()) {
+        return "[No Region Assigned]";
+      } else if (space_id() == 0) {
         return "General Object";
-        break;
-
-      case container:
-        return "Container Object";
-        break;
-
-      case element:
+      } else if ((value() & other_mask) != 0) {
         return "Element Object";
-        break;
-
-      default:
-        return "[No Region Assigned]";
+      } else {
+        return "Container Object";
       }
     }
 };
 
+/*
+ * BDAAllocSite is an allocation site (the bci of a 'new' in some method) that was
+ * given its own region with BDAKlasses="Holder::method@bci". Objects allocated at
+ * the site are registered as containers of that region, whatever their klass.
+ * Excluded sites ("!Holder::method@bci") have the no_region and are never roots.
+ */
+class BDAAllocSite VALUE_OBJ_CLASS_SPEC {
+
+private:
+  int        _bci;
+  BDARegion* _region;
+
+public:
+
+  BDAAllocSite() : _bci(-1), _region(NULL) {}
+  BDAAllocSite(int bci, BDARegion* region) : _bci(bci), _region(region) {}
+
+  int        bci()    const { return _bci; }
+  BDARegion* region() const { return _region; }
+};
+
 #endif // SHARE_VM_GLOBALS_HPP
@@ -0,0 +1,156 @@
+# include "bda/bdaHistogram.hpp"
+# include "gc_implementation/parallelScavenge/parallelScavengeHeap.hpp"
+# include "memory/resourceArea.hpp"
+# include "memory/universe.hpp"
+# include "runtime/safepoint.hpp"
+# include "utilities/ostream.hpp"
+
+#ifdef BDA
+BDASpaceHistogram::BDASpaceHistogram(MutableBDASpace::CGRPSpace * grp, int space_id,
+                                     uint top_n) :
+  _grp(grp), _space_id(space_id), _containers(0), _segments(0), _used_words(0),
+  _capacity_words(0), _top(NULL), _top_n(top_n), _n_top(0) {
+  // No more than the containers of the space can make it to the top
+  _top_n = MIN2(_top_n, (uint)MAX2(grp->container_count(), 0));
+  if (_top_n > 0) {
+    _top = NEW_C_HEAP_ARRAY(BDAContainerFootprint, _top_n, mtGC);
+  }
+}
+
+BDASpaceHistogram::~BDASpaceHistogram()
+{
+  if (_top != NULL) FREE_C_HEAP_ARRAY(BDAContainerFootprint, _top, mtGC);
+}
+
+uint
+BDASpaceHistogram::insert_top(BDAContainerFootprint * top, uint n, uint top_n,
+                              const BDAContainerFootprint & fp)
+{
+  if (top_n == 0 || (n == top_n && top[n - 1]._used_words >= fp._used_words)) {
+    return n;
+  }
+  uint i = n < top_n ? n++ : n - 1;
+  for (; i > 0 && top[i - 1]._used_words < fp._used_words; --i) {
+    top[i] = top[i - 1];
+  }
+  top[i] = fp;
+  return n;
+}
+
+void
+BDASpaceHistogram::compute()
+{
+  assert (SafepointSynchronize::is_at_safepoint(), "must be at a safepoint");
+  _stats.reset();
+
+  for (GenQueueIterator<container_t, mtGC> it = _grp->containers_iterator();
+       *it != NULL;
+       ++it )
+  {
+    container_t const c = *it;
+    const size_t used = pointer_delta(c->_top, c->_start);
+    const size_t capacity = pointer_delta(c->_end, c->_start);
+    _segments += 1;
+    _used_words += used;
+    _capacity_words += capacity;
+    _stats.add_segment(used, capacity);
+
+    // The chain is counted from its head, since its segments may be in other spaces
+    if (c->_prev_segment == NULL) {
+      BDAContainerFootprint fp;
+      fp._head = c;
+      fp._space_id = _space_id;
+      fp._segments = 0;
+      fp._used_words = 0;
+      fp._capacity_words = 0;
+      for (container_t seg = c; seg != NULL; seg = seg->_next_segment) {
+        fp._segments += 1;
+        fp._used_words += pointer_delta(seg->_top, seg->_start);
+        fp._capacity_words += pointer_delta(seg->_end, seg->_start);
+      }
+      _containers += 1;
+      _stats.add_chain(fp._segments);
+      _n_top = insert_top(_top, _n_top, _top_n, fp);
+    }
+  }
+}
+
+void
+BDASpaceHistogram::print_on(outputStream * st) const
+{
+  const double fill = _capacity_words > 0 ? (double)_used_words / _capacity_words : 0.0;
+  st->print_cr("Space %d: " JLONG_FORMAT " containers, " JLONG_FORMAT " segments, "
+               SIZE_FORMAT "K used of " SIZE_FORMAT "K, fill %.1f%%",
+               _space_id, _containers, _segments, _used_words * HeapWordSize / K,
+               _capacity_words * HeapWordSize / K, fill * 100);
+  if (_segments > 0) {
+    _stats.print_histograms_on(st);
+  }
+}
+
+void
+BDAHistogramTask::do_it(GCTaskManager * manager, uint which)
+{
+  _histogram->compute();
+}
+
+void
+VM_BDAHistogram::doit()
+{
+  ResourceMark rm;
+  ParallelScavengeHeap * heap = (ParallelScavengeHeap*)Universe::heap();
+  MutableBDASpace * bda_space = heap->old_gen()->bda_space();
+  const int n = bda_space->spaces()->length();
+
+  BDASpaceHistogram ** histograms = NEW_RESOURCE_ARRAY(BDASpaceHistogram*, n);
+  for (int i = 0; i < n; ++i) {
+    histograms[i] = new BDASpaceHistogram(bda_space->spaces()->at(i), i, _top_n);
+  }
+  if (ParallelGCThreads > 1 && n > 1) {
+    GCTaskQueue * q = GCTaskQueue::create();
+    for (int i = 0; i < n; ++i) {
+      q->enqueue(new BDAHistogramTask(histograms[i]));
+    }
+    ParallelScavengeHeap::gc_task_manager()->execute_and_wait(q);
+  } else {
+    for (int i = 0; i < n; ++i) {
+      histograms[i]->compute();
+    }
+  }
+
+  _out->print_cr("BDA spaces (space 0 is the general object space):");
+  for (int i = 0; i < n; ++i) {
+    histograms[i]->print_on(_out);
+  }
+
+  uint top_n = 0;
+  for (int i = 0; i < n; ++i) {
+    top_n += histograms[i]->n_top();
+  }
+  top_n = MIN2(top_n, _top_n);
+  if (_top_n > 0) {
+    BDAContainerFootprint * top = NEW_RESOURCE_ARRAY(BDAContainerFootprint, top_n);
+    uint n_top = 0;
+    for (int i = 0; i < n; ++i) {
+      for (uint j = 0; j < histograms[i]->n_top(); ++j) {
+        n_top = BDASpaceHistogram::insert_top(top, n_top, top_n, histograms[i]->top(j));
+      }
+    }
+    _out->cr();
+    _out->print_cr("Top %u containers by used bytes:", n_top);
+    _out->print_cr(" num  space  %-18s  segments   used (K)  capacity (K)    fill", "container");
+    for (uint i = 0; i < n_top; ++i) {
+      const BDAContainerFootprint & fp = top[i];
+      _out->print_cr("%4u:  %5d  " PTR_FORMAT "  %8u  " SIZE_FORMAT_W(9) "  "
+                     SIZE_FORMAT_W(12) "  %5.1f%%",
+                     i + 1, fp._space_id, p2i(fp._head->_start), fp._segments,
+                     fp._used_words * HeapWordSize / K,
+                     fp._capacity_words * HeapWordSize / K, fp.fill_ratio() * 100);
+    }
+  }
+
+  for (int i = 0; i < n; ++i) {
+    delete histograms[i];
+  }
+}
+#endif // BDA
@@ -0,0 +1,100 @@
+#ifndef SHARE_VM_BDA_BDAHISTOGRAM_HPP
+#define SHARE_VM_BDA_BDAHISTOGRAM_HPP
+
+# include "bda/bdaStats.hpp"
+# include "bda/mutableBDASpace.hpp"
+# include "gc_implementation/parallelScavenge/gcTaskManager.hpp"
+# include "runtime/vm_operations.hpp"
+
+//
+// BDAContainerFootprint is the footprint of a container, i.e., of the chain of
+// segments that starts at its head, whichever spaces they are in.
+//
+class BDAContainerFootprint VALUE_OBJ_CLASS_SPEC {
+ public:
+  container_t _head;
+  int         _space_id;
+  uint        _segments;
+  // Words below the tops of the segments, and words they span
+  size_t      _used_words;
+  size_t      _capacity_words;
+
+  double fill_ratio() const {
+    return _capacity_words > 0 ? (double)_used_words / (double)_capacity_words : 0.0;
+  }
+};
+
+//
+// BDASpaceHistogram walks the containers of a bda-space and keeps their footprint,
+// the fill ratio and chain length histograms of the walk, and the top_n containers
+// that retain the most words. Each container is counted by the space of its head.
+//
+class BDASpaceHistogram : public CHeapObj<mtGC> {
+
+ private:
+  MutableBDASpace::CGRPSpace * _grp;
+  int                          _space_id;
+  jlong                        _containers;
+  jlong                        _segments;
+  size_t                       _used_words;
+  size_t                       _capacity_words;
+  BDAFragmentationStats        _stats;
+  // The largest containers, the largest first
+  BDAContainerFootprint *      _top;
+  uint                         _top_n;
+  uint                         _n_top;
+
+ public:
+
+  BDASpaceHistogram(MutableBDASpace::CGRPSpace * grp, int space_id, uint top_n);
+  ~BDASpaceHistogram();
+
+  // Must be called at a safepoint. Different spaces may be computed in parallel.
+  void compute();
+
+  int                           space_id()   const { return _space_id; }
+  uint                          n_top()      const { return _n_top; }
+  const BDAContainerFootprint & top(uint i)  const { return _top[i]; }
+
+  void print_on(outputStream * st) const;
+
+  // Inserts fp in top, which is sorted by used words and holds at most top_n
+  // containers, and returns the new number of containers in it.
+  static uint insert_top(BDAContainerFootprint * top, uint n, uint top_n,
+                         const BDAContainerFootprint & fp);
+};
+
+//
+// BDAHistogramTask computes the histogram of a bda-space in a gc thread.
+//
+class BDAHistogramTask : public GCTask {
+ private:
+  BDASpaceHistogram * _histogram;
+
+ public:
+  BDAHistogramTask(BDASpaceHistogram * histogram) : _histogram(histogram) { }
+
+  char * name() { return (char*)"bda-histogram-task"; }
+
+  virtual void do_it(GCTaskManager * manager, uint which);
+};
+
+//
+// VM_BDAHistogram prints the footprint of each space of the MutableBDASpace, and
+// the top_n containers that retain the most words, with their chain length and
+// fill ratio (see the GC.bda_histogram diagnostic command). The spaces are walked
+// in parallel by the gc threads.
+//
+class VM_BDAHistogram : public VM_Operation {
+ private:
+  outputStream * _out;
+  uint           _top_n;
+
+ public:
+  VM_BDAHistogram(outputStream * out, uint top_n) : _out(out), _top_n(top_n) { }
+
+  virtual VMOp_Type type() const { return VMOp_BDAHistogram; }
+  virtual void doit();
+};
+
+#endif // SHARE_VM_BDA_BDAHISTOGRAM_HPP
@@ -1,13 +1,16 @@
 #include "bda/bdaOldPromotionLAB.hpp"
+#include "bda/mutableBDASpace.inline.hpp"
 #include "oops/oop.inline.hpp"
+#include "runtime/atomic.inline.hpp"
 
 // This is the shared initialization code. It sets up the basic pointers,
 // and allows enough extra space for a filler object. We call a virtual
 // method, "lab_is_valid()" to handle the different asserts the old/young
 // labs require.
-void BDAOldPromotionLAB::initialize(MemRegion lab, container_t container)
+void BDAOldPromotionLAB::initialize(MemRegion lab, container_t container, container_t segment)
 {
   _container = container;
+  _segment = segment;
   
   assert(lab_is_valid(lab), "Sanity");
 
@@ -34,6 +37,7 @@ void BDAOldPromotionLAB::initialize(MemRegion lab, container_t container)
     set_end(end);
 
     _state = needs_flush;
+    _desired_words = MIN2(2 * lab.word_size(), max_words());
   } else {
     _state = zero_size;
   }
@@ -41,10 +45,41 @@ void BDAOldPromotionLAB::initialize(MemRegion lab, container_t container)
   assert(this->top() <= this->end(), "pointers out of order");
 }
 
+void
+BDAOldPromotionLAB::flush()
+{
+  assert(_state != flushed, "Attempt to flush PLAB twice");
+
+  if (_state == needs_flush && _segment != NULL) {
+    // The filler would be left unused in the segment until the next full GC. If no
+    // one allocated in the segment past the lab, its top moves back instead.
+    HeapWord* const lab_end = end() + filler_header_size;
+    if ((HeapWord*)Atomic::cmpxchg_ptr(top(), &_segment->_top, lab_end) == lab_end) {
+      _bda_space->note_segment_top(_segment, lab_end, top(), _worker_id);
+      set_bottom(NULL);
+      set_end(NULL);
+      set_top(NULL);
+      _state = flushed;
+      return;
+    }
+  }
+
+  PSOldPromotionLAB::flush();
+}
+
+void
+BDAOldPromotionLAB::set_container(container_t container)
+{
+  assert(_state != needs_flush, "the lab must be flushed first");
+  _container = container;
+  _segment = NULL;
+  _desired_words = BDAOldPLABSize;
+}
+
 HeapWord*
 BDAOldPromotionLAB::allocate(size_t size, container_t container)
 {
-  if (_container != container) {
+  if (!owns(container)) {
     return NULL;
   } else {
     return PSOldPromotionLAB::allocate (size);
@@ -55,11 +90,100 @@ BDAOldPromotionLAB::allocate(size_t size, container_t container)
 bool
 BDAOldPromotionLAB::lab_is_valid (MemRegion lab)
 {
-  if (_container == NULL)
+  if (_segment == NULL)
     return true;
   else {
-    MemRegion used = MemRegion (_container->_start, _container->_top);
+    MemRegion used = MemRegion (_segment->_start, _segment->_top);
     return used.contains(lab);
   }
 }
 #endif // ASSERT
+
+void
+BDAOldPromotionLABSet::initialize(ObjectStartArray* start_array, MutableBDASpace* bda_space)
+{
+  _n_labs = (uint)MAX2(BDAOldPLABCount, (uintx)1);
+  _labs = NEW_C_HEAP_ARRAY(BDAOldPromotionLAB*, _n_labs, mtGC);
+  for (uint i = 0; i < _n_labs; i++) {
+    _labs[i] = new BDAOldPromotionLAB(start_array, bda_space);
+  }
+}
+
+void
+BDAOldPromotionLABSet::set_worker_id(uint worker_id)
+{
+  for (uint i = 0; i < _n_labs; i++) {
+    _labs[i]->set_worker_id(worker_id);
+  }
+}
+
+void
+BDAOldPromotionLABSet::reset(HeapWord* lab_base)
+{
+  for (uint i = 0; i < _n_labs; i++) {
+    _labs[i]->initialize(MemRegion(lab_base, (size_t)0), NULL, NULL);
+    _labs[i]->set_container(NULL);
+  }
+}
+
+void
+BDAOldPromotionLABSet::flush()
+{
+  for (uint i = 0; i < _n_labs; i++) {
+    if (!_labs[i]->is_flushed()) {
+      _labs[i]->flush();
+    }
+  }
+}
+
+inline void
+BDAOldPromotionLABSet::move_to_front(uint i)
+{
+  BDAOldPromotionLAB* const lab = _labs[i];
+  for (; i > 0; i--) {
+    _labs[i] = _labs[i - 1];
+  }
+  _labs[0] = lab;
+}
+
+HeapWord*
+BDAOldPromotionLABSet::allocate(size_t size, container_t container)
+{
+  for (uint i = 0; i < _n_labs; i++) {
+    if (_labs[i]->owns(container)) {
+      move_to_front(i);
+      return _labs[0]->allocate(size, container);
+    }
+  }
+  return NULL;
+}
+
+size_t
+BDAOldPromotionLABSet::desired_words(container_t container) const
+{
+  for (uint i = 0; i < _n_labs; i++) {
+    if (_labs[i]->owns(container)) {
+      return _labs[i]->desired_words();
+    }
+  }
+  return BDAOldPLABSize;
+}
+
+BDAOldPromotionLAB*
+BDAOldPromotionLABSet::lab_for(container_t container)
+{
+  for (uint i = 0; i < _n_labs; i++) {
+    if (_labs[i]->owns(container)) {
+      move_to_front(i);
+      return _labs[0];
+    }
+  }
+
+  BDAOldPromotionLAB* const lab = _labs[_n_labs - 1];
+  if (!lab->is_flushed()) {
+    lab->flush();
+  }
+  lab->set_container(container);
+  move_to_front(_n_labs - 1);
+  return lab;
+}
@@ -3,6 +3,8 @@
 
 #include "gc_implementation/parallelScavenge/psPromotionLAB.hpp"
 #include "bda/bdaGlobals.hpp"
+
+class MutableBDASpace;
 /*
  * BDAOldPromotionLAB acts as an array of PSPromotionLAB objects, specially
  * of PSOldPromotionLAB. Thus, the relation between BDAOldPromotionLAB and
@@ -16,23 +18,90 @@ class BDAOldPromotionLAB : public PSOldPromotionLAB {
 
  private:
 
+  // The container whose elements the lab takes, and the segment the lab lies in,
+  // which is the container itself or one of its later segments.
   container_t  _container;
+  container_t  _segment;
+  // The size of the next lab of the container. It doubles on each refill, up to
+  // max_words(), and starts at BDAOldPLABSize for each container taken.
+  size_t       _desired_words;
+  // The space the segments are in, and the id of the gc thread the lab belongs to,
+  // which records the words given back in its fragmentation stats.
+  MutableBDASpace * _bda_space;
+  uint              _worker_id;
 
  public:
   // The first constructor does not need initialization since it is the default for
   // value objects.
-  BDAOldPromotionLAB() : PSOldPromotionLAB(NULL) {}
-  BDAOldPromotionLAB(ObjectStartArray* start_array) : PSOldPromotionLAB(start_array) {}
+  BDAOldPromotionLAB() : PSOldPromotionLAB(NULL),
+    _container(NULL), _segment(NULL), _desired_words(BDAOldPLABSize),
+    _bda_space(NULL), _worker_id(0) {}
+  BDAOldPromotionLAB(ObjectStartArray* start_array, MutableBDASpace* bda_space) :
+    PSOldPromotionLAB(start_array),
+    _container(NULL), _segment(NULL), _desired_words(BDAOldPLABSize),
+    _bda_space(bda_space), _worker_id(0) {}
+
+  static size_t max_words() { return BDAOldPLABSize * 8; }
 
-  void initialize(MemRegion lab, container_t container);
-  void flush()
-    { PSOldPromotionLAB::flush(); }
+  void initialize(MemRegion lab, container_t container, container_t segment);
+  // Gives the unused words back to the segment if the lab still ends at its top.
+  // Otherwise they are filled, as in the other old labs.
+  void flush();
   // Call the set_start_array on super class
   void set_start_array(ObjectStartArray* start_array)
     { PSOldPromotionLAB::set_start_array(start_array); }
   HeapWord * allocate(size_t size, container_t container);
 
+  container_t container()     const { return _container; }
+  // The elements pushed from the segments of the lab come with either one
+  bool        owns(container_t c) const {
+    return c != NULL && (c == _container || c == _segment);
+  }
+  size_t      desired_words() const { return _desired_words; }
+  void        set_worker_id(uint worker_id) { _worker_id = worker_id; }
+  // Hands the flushed lab to the elements of container
+  void        set_container(container_t container);
+
   debug_only(virtual bool lab_is_valid(MemRegion lab));
 };
 
+/*
+ * BDAOldPromotionLABSet holds the labs of a promotion manager for the last
+ * BDAOldPLABCount containers it promoted elements of, so that elements of
+ * interleaved containers do not flush each other's lab. When the elements of
+ * another container come, the least recently used lab is flushed and handed to it.
+ */
+class BDAOldPromotionLABSet VALUE_OBJ_CLASS_SPEC {
+
+ private:
+
+  // The labs, the most recently used first
+  BDAOldPromotionLAB ** _labs;
+  uint                  _n_labs;
+
+  inline void move_to_front(uint i);
+
+ public:
+
+  BDAOldPromotionLABSet() : _labs(NULL), _n_labs(0) {}
+
+  void initialize(ObjectStartArray* start_array, MutableBDASpace* bda_space);
+  void set_worker_id(uint worker_id);
+  // Sets all labs to zero-size at lab_base, for no container
+  void reset(HeapWord* lab_base);
+  void flush();
+
+  // Allocates in the lab of container, if there is one with enough words left
+  HeapWord *           allocate(size_t size, container_t container);
+  // The size of the next lab of container
+  size_t               desired_words(container_t container) const;
+  // The lab of container, which is the least recently used one, flushed, if the
+  // container has none.
+  BDAOldPromotionLAB * lab_for(container_t container);
+  // Gives back the last object allocated, if it was in a lab
+  bool                 unallocate_object(HeapWord* obj, size_t obj_size) {
+    return _labs[0]->unallocate_object(obj, obj_size);
+  }
+};
+
 #endif // SHARE_VM_GC_IMPLEMENTATION_PARALLELSCAVENGE_BDAOLDPROMOTIONLAB_HPP
@@ -1,51 +1,46 @@
 #include "gc_implementation/parallelScavenge/parallelScavengeHeap.hpp"
 #include "bda/bdaParallelCompact.hpp"
 
-typedef BDADataCounters::CounterData CounterData;
-
-CounterData*
-BDADataCounters::initialize_counter_data(size_t region_count)
-{
-  int counter_sz = ((MutableBDASpace*)ParallelScavengeHeap::old_gen()->object_space())->spaces()->length();
-  // Would it be easier to use array initialization? That'd require the CounterData
-  // to be a ResourceObj...
-  _map = NEW_C_HEAP_ARRAY(CounterData, region_count, mtGC);
-
-  for(int idx = 0; idx < (int)region_count; ++idx) {
-    _map[idx].initialize(counter_sz);
-  }
-  return _map;
-}
-
-void
-BDADataCounters::CounterData::initialize(int counter_sz)
+BDADataCounters::BDADataCounters(size_t region_count, int counter_sz) :
+  _region_count(region_count), _counter_sz(counter_sz)
 {
-  _counters = NEW_C_HEAP_ARRAY(int, counter_sz, mtGC);
-  memset(_counters, 0, sizeof(int)*counter_sz);
+  _counters = NEW_C_HEAP_ARRAY(jint, region_count * counter_sz, mtGC);
+  memset(_counters, 0, sizeof(jint) * region_count * counter_sz);
 }
 
-void
-BDADataCounters::CounterData::incr_counter(int id)
+BDADataCounters::~BDADataCounters()
 {
-  _counters[id] += 1;
+  FREE_C_HEAP_ARRAY(jint, _counters, mtGC);
 }
 
 int
-BDADataCounters::most_counts_id(size_t region_idx)
+BDADataCounters::most_counts_id(size_t region_idx, jint * count, jint * total) const
 {
-  int* counters = _map[region_idx].counters();
-  int max = 0, acc = 0;
-  // FIXME: Here idx is 1 in order to prefer targets with at least 1 object
-  // of the kind. In the future use heuristics!
+  const jint * const counters = counters_at(region_idx);
+  int max = 0;
+  jint acc = 0, sum = counters[0];
+  // idx starts at 1, since the objects not reached from a bda-space have
+  // nowhere to go but the old space.
   for(int idx = 1; idx < _counter_sz; ++idx) {
     if (counters[idx] > acc) {
       max = idx;
       acc = counters[idx];
     }
+    sum += counters[idx];
   }
+  *count = acc;
+  *total = sum;
   return max;
 }
 
+void
+BDADataCounters::clear_range(size_t beg_region, size_t end_region)
+{
+  assert (beg_region <= end_region && end_region <= _region_count, "range out of bounds");
+  memset(_counters + beg_region * _counter_sz, 0,
+         sizeof(jint) * (end_region - beg_region) * _counter_sz);
+}
+
 /* BDASummaryMap implementation */
 BDASummaryMap::BDASummaryMap()
 {
@@ -73,8 +68,7 @@ BDASummaryMap::reset()
 void
 BDASummaryMap::set_end_word(int id, HeapWord* v)
 {
-  // adjust the id because the ids for bda spaces are after the to_space id.
-  // see SpaceId.
+  // the id is the space id of MutableBDASpace::spaces(), not a SpaceId (see BDARegion)
   assert(id < _length, "id is non exists in collections array");
   _target_ends[id] = v;
 }
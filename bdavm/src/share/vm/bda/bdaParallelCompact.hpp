@@ -4,6 +4,7 @@
 #include "utilities/growableArray.hpp"
 #include "utilities/globalDefinitions.hpp"
 #include "bda/mutableBDASpace.hpp"
+#include "runtime/atomic.inline.hpp"
 
 /* This file provides multiple auxiliary classes to aid the ParallelCompact GC when
  * adapted to the BDA Spaces. The classes in this file are carefuly introduced in the
@@ -11,35 +12,48 @@
  * flags to hide the various implemetations at compile time.
  */
 
+// BDADataCounters keeps, for each region of the heap, how many of the objects marked
+// in it were first reached from the containers of each bda-space. Index 0 counts the
+// objects reached from anywhere else. The counts are taken during marking, by the gc
+// threads concurrently, and are used in the summary phase to move the regions of the
+// old space whose objects belong with the containers of one bda-space into that space
+// (see BDAThreshold and PSParallelCompact::summarize_stray_regions).
 class BDADataCounters : public CHeapObj<mtGC> {
 
-public:
-
-  class CounterData : public CHeapObj<mtGC>  {
-
-  private:
-    size_t _region_id;
-    int*   _counters;
-
-  public:
+private:
+  // The counters of region r are at [r * _counter_sz, (r + 1) * _counter_sz)
+  jint * _counters;
+  size_t _region_count;
+  int    _counter_sz;
 
-    void initialize(int counter_sz);
-    void incr_counter(int id);
-    int* counters() { return _counters; }
-  };
+  jint * counters_at(size_t region_idx) const {
+    assert (region_idx < _region_count, "region_idx out of range");
+    return _counters + region_idx * _counter_sz;
+  }
 
-  BDADataCounters(int counter_sz) : _counter_sz(counter_sz) {}
+public:
 
-  CounterData* initialize_counter_data(size_t region_count);
-  int most_counts_id(size_t region_idx);
+  BDADataCounters(size_t region_count, int counter_sz);
+  ~BDADataCounters();
 
-  int counter_size() { return _counter_sz; }
-private:
-  CounterData* _map;
-  int _counter_sz;
+  inline void incr_counter(size_t region_idx, int id);
+  // Returns the bda-space that reached most of the objects of the region, or 0 if no
+  // bda-space reached any. Its count and the count of all spaces are returned in count
+  // and total.
+  int  most_counts_id(size_t region_idx, jint * count, jint * total) const;
+  // Resets the counters of [beg_region, end_region) for the next collection.
+  void clear_range(size_t beg_region, size_t end_region);
 
+  int counter_size() const { return _counter_sz; }
 };
 
+inline void
+BDADataCounters::incr_counter(size_t region_idx, int id)
+{
+  assert (id >= 0 && id < _counter_sz, "id out of range");
+  Atomic::inc(counters_at(region_idx) + id);
+}
+
 class BDASummaryMap VALUE_OBJ_CLASS_SPEC {
 
 private:
@@ -0,0 +1,224 @@
+# include "bda/bdaPhaseTimes.hpp"
+# include "gc_implementation/shared/gcTimer.hpp"
+# include "gc_implementation/shared/gcTrace.hpp"
+# include "runtime/os.hpp"
+# include "utilities/ostream.hpp"
+# include "utilities/ticks.inline.hpp"
+
+#ifdef BDA
+const char * BDAPhaseTimes::_par_phase_names[BDAPhaseTimes::ParPhasesSentinel] = {
+  "BDA Segment Scan",
+  "BDA Root Draining",
+  "BDA Stealing",
+  "BDA Other Space Scan",
+  "BDA Space Summary",
+  "BDA Region Compaction"
+};
+
+// NULL if the phase counts no work items
+const char * BDAPhaseTimes::_work_item_names[BDAPhaseTimes::ParPhasesSentinel] = {
+  "Chunks",
+  "Roots",
+  "Steals",
+  NULL,
+  "Spaces",
+  "Regions"
+};
+
+const char * BDAPhaseTimes::_serial_phase_names[BDAPhaseTimes::SerialPhasesSentinel] = {
+  "BDA Root Setup",
+  "BDA Layout",
+  "BDA Prepare",
+  "BDA Summary",
+  "BDA Post Compact"
+};
+
+BDAPhaseTimes::BDAPhaseTimes(uint max_workers) :
+  _max_workers(MAX2(max_workers, 1U)), _full_gc(false) {
+  for (int i = 0; i < ParPhasesSentinel; i++) {
+    _par_times[i] = NEW_C_HEAP_ARRAY(double, _max_workers, mtGC);
+    _work_items[i] = NEW_C_HEAP_ARRAY(size_t, _max_workers, mtGC);
+  }
+  note_gc_start(false);
+}
+
+BDAPhaseTimes::~BDAPhaseTimes()
+{
+  for (int i = 0; i < ParPhasesSentinel; i++) {
+    FREE_C_HEAP_ARRAY(double, _par_times[i], mtGC);
+    FREE_C_HEAP_ARRAY(size_t, _work_items[i], mtGC);
+  }
+}
+
+void
+BDAPhaseTimes::note_gc_start(bool full_gc)
+{
+  _full_gc = full_gc;
+  for (int i = 0; i < ParPhasesSentinel; i++) {
+    for (uint w = 0; w < _max_workers; w++) {
+      _par_times[i][w] = -1.0;
+      _work_items[i][w] = 0;
+    }
+  }
+  for (int i = 0; i < SerialPhasesSentinel; i++) {
+    _serial_times[i] = 0.0;
+  }
+}
+
+void
+BDAPhaseTimes::add_time_secs(ParPhases phase, uint worker, double secs)
+{
+  assert (worker < _max_workers, "worker out of range");
+  double * const t = &_par_times[phase][worker];
+  *t = MAX2(*t, 0.0) + secs * MILLIUNITS;
+}
+
+void
+BDAPhaseTimes::add_work_items(ParPhases phase, uint worker, size_t count)
+{
+  assert (worker < _max_workers, "worker out of range");
+  _work_items[phase][worker] += count;
+}
+
+void
+BDAPhaseTimes::add_serial_time_secs(SerialPhases phase, double secs)
+{
+  _serial_times[phase] += secs * MILLIUNITS;
+}
+
+uint
+BDAPhaseTimes::par_phase_stats(ParPhases phase, double * min, double * avg,
+                               double * max, double * sum) const
+{
+  uint n = 0;
+  *min = *max = *sum = 0.0;
+  for (uint w = 0; w < _max_workers; w++) {
+    const double t = _par_times[phase][w];
+    if (t < 0.0) continue;
+    *min = n == 0 ? t : MIN2(*min, t);
+    *max = MAX2(*max, t);
+    *sum += t;
+    n++;
+  }
+  *avg = n > 0 ? *sum / n : 0.0;
+  return n;
+}
+
+size_t
+BDAPhaseTimes::sum_work_items(ParPhases phase) const
+{
+  size_t sum = 0;
+  for (uint w = 0; w < _max_workers; w++) {
+    sum += _work_items[phase][w];
+  }
+  return sum;
+}
+
+double
+BDAPhaseTimes::average_time_ms(ParPhases phase) const
+{
+  double min, avg, max, sum;
+  par_phase_stats(phase, &min, &avg, &max, &sum);
+  return avg;
+}
+
+void
+BDAPhaseTimes::print() const
+{
+  gclog_or_tty->print_cr("[BDA Times (ms):");
+  for (int i = 0; i < SerialPhasesSentinel; i++) {
+    const SerialPhases phase = (SerialPhases)i;
+    if (is_scavenge_phase(phase) == _full_gc) continue;
+    gclog_or_tty->print_cr("   [%s: %.1lf]", _serial_phase_names[i], _serial_times[i]);
+  }
+  for (int i = 0; i < ParPhasesSentinel; i++) {
+    const ParPhases phase = (ParPhases)i;
+    if (is_scavenge_phase(phase) == _full_gc) continue;
+    double min, avg, max, sum;
+    const uint n = par_phase_stats(phase, &min, &avg, &max, &sum);
+    if (n == 0) continue;
+    gclog_or_tty->print_cr("   [%s (ms): Min: %.1lf, Avg: %.1lf, Max: %.1lf, Diff: %.1lf,"
+                           " Sum: %.1lf, GC Workers: %u]",
+                           _par_phase_names[i], min, avg, max, max - min, sum, n);
+    if (PrintGCDetails && Verbose) {
+      gclog_or_tty->print("      [Workers:");
+      for (uint w = 0; w < _max_workers; w++) {
+        if (_par_times[i][w] >= 0.0) {
+          gclog_or_tty->print(" %.1lf", _par_times[i][w]);
+        }
+      }
+      gclog_or_tty->print_cr("]");
+    }
+    if (_work_item_names[i] != NULL) {
+      gclog_or_tty->print_cr("      [%s: " SIZE_FORMAT "]",
+                             _work_item_names[i], sum_work_items(phase));
+    }
+  }
+  gclog_or_tty->print_cr("]");
+}
+
+void
+BDAPhaseTimes::report(GCTracer * tracer) const
+{
+  for (int i = 0; i < ParPhasesSentinel; i++) {
+    const ParPhases phase = (ParPhases)i;
+    if (is_scavenge_phase(phase) == _full_gc) continue;
+    double min, avg, max, sum;
+    const uint n = par_phase_stats(phase, &min, &avg, &max, &sum);
+    if (n == 0) continue;
+    tracer->report_bda_phase_time(_par_phase_names[i], n, min, avg, max, sum,
+                                  sum_work_items(phase));
+  }
+}
+
+BDAPhaseTimer::BDAPhaseTimer(BDAPhaseTimes * phase_times, BDAPhaseTimes::ParPhases phase,
+                             uint worker) :
+  _phase_times(phase_times), _phase(phase), _worker(worker), _start(os::elapsedTime()) {
+}
+
+BDAPhaseTimer::~BDAPhaseTimer()
+{
+  _phase_times->add_time_secs(_phase, _worker, os::elapsedTime() - _start);
+}
+
+BDASerialPhaseTimer::BDASerialPhaseTimer(BDAPhaseTimes * phase_times,
+                                         BDAPhaseTimes::SerialPhases phase,
+                                         bool doit, bool print_cr, GCTimer * timer,
+                                         GCId gc_id) :
+  _phase_times(phase_times), _phase(phase), _doit(doit), _print_cr(print_cr),
+  _timer(timer), _start() {
+  _start.stamp();
+  const char * const title = BDAPhaseTimes::serial_phase_name(phase);
+  if (_timer != NULL) {
+    _timer->register_gc_phase_start(title, _start);
+  }
+  if (_doit) {
+    gclog_or_tty->date_stamp(PrintGCDateStamps);
+    gclog_or_tty->stamp(PrintGCTimeStamps);
+    if (PrintGCID) {
+      gclog_or_tty->print("#%u: ", gc_id.id());
+    }
+    gclog_or_tty->print("[%s", title);
+    gclog_or_tty->flush();
+  }
+}
+
+BDASerialPhaseTimer::~BDASerialPhaseTimer()
+{
+  Ticks stop;
+  stop.stamp();
+  if (_timer != NULL) {
+    _timer->register_gc_phase_end(stop);
+  }
+  const double secs = TicksToTimeHelper::seconds(stop - _start);
+  _phase_times->add_serial_time_secs(_phase, secs);
+  if (_doit) {
+    if (_print_cr) {
+      gclog_or_tty->print_cr(", %3.7f secs]", secs);
+    } else {
+      gclog_or_tty->print(", %3.7f secs]", secs);
+    }
+    gclog_or_tty->flush();
+  }
+}
+#endif // BDA
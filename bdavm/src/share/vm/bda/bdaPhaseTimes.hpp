@@ -0,0 +1,124 @@
+#ifndef SHARE_VM_BDA_BDAPHASETIMES_HPP
+#define SHARE_VM_BDA_BDAPHASETIMES_HPP
+
+# include "memory/allocation.hpp"
+# include "gc_implementation/shared/gcId.hpp"
+# include "utilities/ticks.hpp"
+
+class GCTimer;
+class GCTracer;
+
+//
+// BDAPhaseTimes holds the times of the phases the bda-spaces add to a GC, in a similar
+// fashion to G1GCPhaseTimes. The parallel phases are the bda tasks of a scavenge and
+// the summary and compaction of the bda-spaces of a full GC, and are recorded per gc
+// thread along with the work items each thread claimed. The serial phases are the bda
+// work done by the VM thread. They are printed with PrintGCDetails at the end of the GC
+// and the parallel ones are sent to the GC tracer (the serial ones are already sent as
+// phases of the GC timer).
+//
+class BDAPhaseTimes : public CHeapObj<mtGC> {
+
+ public:
+  enum ParPhases {
+    // Scavenge
+    OldToYoungBDARoots,
+    BDARefRoots,
+    StealBDARef,
+    OldToYoungNonBDARoots,
+    // Full GC
+    SummarizeBDASpace,
+    CompactBDARegions,
+    ParPhasesSentinel
+  };
+
+  enum SerialPhases {
+    // Scavenge
+    RootSetup,
+    Layout,
+    // Full GC
+    Prepare,
+    Summary,
+    PostCompact,
+    SerialPhasesSentinel
+  };
+
+ private:
+  uint     _max_workers;
+  // Milliseconds spent by each worker in each parallel phase, or a negative time if
+  // the worker did not run the phase in this GC
+  double * _par_times[ParPhasesSentinel];
+  size_t * _work_items[ParPhasesSentinel];
+  double   _serial_times[SerialPhasesSentinel];
+  bool     _full_gc;
+
+  static const char * _par_phase_names[ParPhasesSentinel];
+  static const char * _work_item_names[ParPhasesSentinel];
+  static const char * _serial_phase_names[SerialPhasesSentinel];
+
+  // Min, average, max and sum of the times of the workers that ran phase. Returns the
+  // number of these workers.
+  uint par_phase_stats(ParPhases phase, double * min, double * avg,
+                       double * max, double * sum) const;
+  size_t sum_work_items(ParPhases phase) const;
+  bool   is_scavenge_phase(ParPhases phase) const { return phase < SummarizeBDASpace; }
+  bool   is_scavenge_phase(SerialPhases phase) const { return phase < Prepare; }
+
+ public:
+
+  BDAPhaseTimes(uint max_workers);
+  ~BDAPhaseTimes();
+
+  // Forgets the times of the last GC
+  void note_gc_start(bool full_gc);
+
+  // Adds secs to the time worker spent in phase, since a worker may run several
+  // tasks of the same phase
+  void add_time_secs(ParPhases phase, uint worker, double secs);
+  void add_work_items(ParPhases phase, uint worker, size_t count);
+  void add_serial_time_secs(SerialPhases phase, double secs);
+
+  double average_time_ms(ParPhases phase) const;
+
+  void print() const;
+  void report(GCTracer * tracer) const;
+
+  static const char * par_phase_name(ParPhases phase) { return _par_phase_names[phase]; }
+  static const char * serial_phase_name(SerialPhases phase) { return _serial_phase_names[phase]; }
+};
+
+//
+// BDAPhaseTimer adds the time from its construction to its destruction to a parallel
+// phase of a gc thread.
+//
+class BDAPhaseTimer : public StackObj {
+  BDAPhaseTimes *           _phase_times;
+  BDAPhaseTimes::ParPhases  _phase;
+  uint                      _worker;
+  double                    _start;
+
+ public:
+  BDAPhaseTimer(BDAPhaseTimes * phase_times, BDAPhaseTimes::ParPhases phase, uint worker);
+  ~BDAPhaseTimer();
+};
+
+//
+// BDASerialPhaseTimer adds the time from its construction to its destruction to a
+// serial phase. Like GCTraceTime, it also registers the phase in the GC timer, if any,
+// and prints it if doit, from the same measurement.
+//
+class BDASerialPhaseTimer : public StackObj {
+  BDAPhaseTimes *              _phase_times;
+  BDAPhaseTimes::SerialPhases  _phase;
+  bool                         _doit;
+  bool                         _print_cr;
+  GCTimer *                    _timer;
+  Ticks                        _start;
+
+ public:
+  BDASerialPhaseTimer(BDAPhaseTimes * phase_times, BDAPhaseTimes::SerialPhases phase,
+                      bool doit, bool print_cr, GCTimer * timer, GCId gc_id);
+  ~BDASerialPhaseTimer();
+};
+
+#endif // SHARE_VM_BDA_BDAPHASETIMES_HPP
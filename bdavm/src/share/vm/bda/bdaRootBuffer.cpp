@@ -0,0 +1,43 @@
+# include "bda/bdaRootBuffer.hpp"
+# include "bda/refqueue.hpp"
+# include "gc_interface/collectedHeap.hpp"
+# include "memory/universe.hpp"
+
+#if defined(BDA) || defined(BDA_INTERPRETER)
+BDARootBuffer::~BDARootBuffer()
+{
+  if (_buf != NULL) {
+    assert (is_empty(), "logged roots would be lost");
+    Universe::heap()->bda_refqueue()->deallocate_buffer(_buf);
+    _buf = NULL;
+  }
+}
+
+void
+BDARootBuffer::handle_zero_index()
+{
+  assert (_index == 0, "should only be called when the buffer is full");
+  RefQueue * refqueue = Universe::heap()->bda_refqueue();
+  if (_buf != NULL) {
+    // The buffer is full, hand it over to the gc as a whole.
+    refqueue->enqueue_completed_buffer(_buf, _index);
+  }
+  // Threads that never allocate containers never get a buffer.
+  _buf   = refqueue->allocate_buffer();
+  _sz    = refqueue->buffer_size();
+  _index = _sz;
+}
+
+void
+BDARootBuffer::flush()
+{
+  if (_buf == NULL) return;
+
+  // Even an empty buffer is completed: it is recycled at the next safepoint,
+  // which is when the free list may be safely pushed to.
+  Universe::heap()->bda_refqueue()->enqueue_completed_buffer(_buf, _index);
+  _buf   = NULL;
+  _index = 0;
+  _sz    = 0;
+}
+#endif // BDA || BDA_INTERPRETER
@@ -0,0 +1,69 @@
+#ifndef SHARE_VM_BDA_BDAROOTBUFFER_HPP
+#define SHARE_VM_BDA_BDAROOTBUFFER_HPP
+
+# include "memory/allocation.hpp"
+# include "oops/oopsHierarchy.hpp"
+# include "bda/bdaGlobals.hpp"
+# include "utilities/sizes.hpp"
+
+//
+// BDARootBuffer is a thread-local log of newly allocated bda roots, i.e., objects whose
+// klass is mapped to one of the bda-spaces. Each entry is a pair [oop, BDARegion*].
+// The buffer is filled from its end towards index zero, in a similar fashion to
+// PtrQueue (see g1/ptrQueue.hpp), so that generated code only needs to compare the
+// index with zero before appending. Only when the buffer is full (or not yet allocated)
+// does the mutator call into the runtime, which hands the whole buffer to the RefQueue
+// (see refqueue.hpp) and takes a recycled one from it.
+//
+class BDARootBuffer VALUE_OBJ_CLASS_SPEC {
+  friend class VMStructs;
+
+ private:
+  // The buffer, with entry_words words for each entry.
+  void ** _buf;
+  // The byte index at which the last root was logged. Starts at _sz (an empty buffer)
+  // and goes towards zero.
+  size_t  _index;
+  // The size of the buffer in bytes.
+  size_t  _sz;
+
+  // Completes the buffer, if it was already allocated, and gets a new one.
+  void handle_zero_index();
+
+ public:
+  // Number of words of each entry: the oop and its BDARegion*.
+  enum { entry_words = 2 };
+
+  BDARootBuffer() : _buf(NULL), _index(0), _sz(0) { }
+  ~BDARootBuffer();
+
+  inline void enqueue(oop obj, BDARegion * r);
+  // Completes the buffer, with every logged root, on the RefQueue. The next
+  // enqueue gets a new buffer.
+  void        flush();
+
+  bool   is_empty() const { return _buf == NULL || _index == _sz; }
+  size_t size()     const { return _buf == NULL ? 0 : (_sz - _index) / (entry_words * oopSize); }
+
+  // Compiler support
+  static ByteSize byte_offset_of_buf()   { return byte_offset_of(BDARootBuffer, _buf); }
+  static ByteSize byte_offset_of_index() { return byte_offset_of(BDARootBuffer, _index); }
+  static int      entry_size_in_bytes()  { return entry_words * oopSize; }
+};
+
+// Inline definitions
+
+inline void
+BDARootBuffer::enqueue(oop obj, BDARegion * r)
+{
+  if (_index == 0) {
+    handle_zero_index();
+  }
+  assert (_index >= (size_t)entry_size_in_bytes() && _index <= _sz, "index out of bounds");
+  _index -= entry_size_in_bytes();
+  void ** entry = &_buf[_index / oopSize];
+  entry[0] = (void*)obj;
+  entry[1] = (void*)r;
+}
+
+#endif // SHARE_VM_BDA_BDAROOTBUFFER_HPP
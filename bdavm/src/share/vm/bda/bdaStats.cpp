@@ -0,0 +1,73 @@
+# include "bda/bdaStats.hpp"
+# include "utilities/ostream.hpp"
+
+#ifdef BDA
+void
+BDAFragmentationStats::reset()
+{
+  _segments = 0;
+  _fill_sum = 0.0;
+  _fill_sq_sum = 0.0;
+  for (int i = 0; i < FillBuckets; i++) {
+    _fill_hist[i] = 0;
+  }
+  for (int i = 0; i < ChainBuckets; i++) {
+    _chain_hist[i] = 0;
+  }
+}
+
+void
+BDAFragmentationStats::fold(BDAFragmentationStats * deltas)
+{
+  _segments    += deltas->_segments;
+  _fill_sum    += deltas->_fill_sum;
+  _fill_sq_sum += deltas->_fill_sq_sum;
+  for (int i = 0; i < FillBuckets; i++) {
+    _fill_hist[i] += deltas->_fill_hist[i];
+  }
+  for (int i = 0; i < ChainBuckets; i++) {
+    _chain_hist[i] += deltas->_chain_hist[i];
+  }
+  deltas->reset();
+}
+
+double
+BDAFragmentationStats::mean_fragmentation() const
+{
+  if (_segments <= 0) return 0.0;
+  return 1.0 - _fill_sum / _segments;
+}
+
+double
+BDAFragmentationStats::fragmentation_variance() const
+{
+  if (_segments <= 0) return 0.0;
+  const double mean = _fill_sum / _segments;
+  // The sums drift a little with each update, so the difference may fall below zero
+  return MAX2(_fill_sq_sum / _segments - mean * mean, 0.0);
+}
+
+void
+BDAFragmentationStats::print_histograms_on(outputStream * st) const
+{
+  st->print("  Segments by fill ratio =");
+  for (int i = 0; i < FillBuckets; i++) {
+    st->print(" [%d-%d%%: " JLONG_FORMAT "]", i * 100 / FillBuckets,
+              (i + 1) * 100 / FillBuckets, _fill_hist[i]);
+  }
+  st->cr();
+  st->print("  Containers by segments =");
+  for (int i = 0; i < ChainBuckets; i++) {
+    const uint lo = i == 0 ? 1 : (1U << (i - 1)) + 1;
+    const uint hi = 1U << i;
+    if (i == ChainBuckets - 1) {
+      st->print(" [%u+: " JLONG_FORMAT "]", lo, _chain_hist[i]);
+    } else if (lo == hi) {
+      st->print(" [%u: " JLONG_FORMAT "]", lo, _chain_hist[i]);
+    } else {
+      st->print(" [%u-%u: " JLONG_FORMAT "]", lo, hi, _chain_hist[i]);
+    }
+  }
+  st->cr();
+}
+#endif // BDA
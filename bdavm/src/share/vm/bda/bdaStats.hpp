@@ -1,5 +1,10 @@
+#ifndef SHARE_VM_BDA_BDASTATS_HPP
+#define SHARE_VM_BDA_BDASTATS_HPP
+
 # include "memory/allocation.hpp"
 
+class outputStream;
+
 class BDAPromotionStats VALUE_OBJ_CLASS_SPEC {
 
  private:
@@ -14,3 +19,99 @@ class BDAPromotionStats VALUE_OBJ_CLASS_SPEC {
   void failed_element_promotion() { _failed_element_oops_count += 1; }
   
 };
+
+//
+// BDAFragmentationStats holds the running sums of the fill ratio of the segments of a
+// bda-space, i.e., the fraction of each one below its top, and the histograms of the
+// fill ratio and of the length of the chains of segments of its containers. They are
+// kept on the allocation of segments and on the moves of their tops, so the mean and
+// the variance of the fragmentation need no walk of the containers.
+// The same class holds the deltas each gc thread records during a scavenge, which are
+// folded into the ones of the space at its end, so that the counts may be negative.
+//
+class BDAFragmentationStats VALUE_OBJ_CLASS_SPEC {
+
+ public:
+  enum {
+    // Of 10% each, the last one including the full segments
+    FillBuckets  = 10,
+    // Of the lengths 1, 2, 3-4, 5-8, ..., 33-64 and 65 or more
+    ChainBuckets = 8
+  };
+
+ private:
+  jlong  _segments;
+  double _fill_sum;
+  double _fill_sq_sum;
+  jlong  _fill_hist[FillBuckets];
+  jlong  _chain_hist[ChainBuckets];
+
+  static inline double fill_ratio(size_t used, size_t capacity) {
+    return capacity > 0 ? (double)used / (double)capacity : 1.0;
+  }
+  static inline int    fill_bucket(double fill) {
+    const int b = (int)(fill * FillBuckets);
+    return MIN2(MAX2(b, 0), (int)FillBuckets - 1);
+  }
+  static inline int    chain_bucket(uint length) {
+    int b = 0;
+    for (uint l = 1; l < length && b < ChainBuckets - 1; l <<= 1) b++;
+    return b;
+  }
+
+ public:
+
+  BDAFragmentationStats() { reset(); }
+
+  void reset();
+
+  // A segment with used of its capacity words below its top
+  inline void add_segment(size_t used, size_t capacity);
+  // The top of a segment moved from old_used to new_used words above its start
+  inline void update_fill(size_t old_used, size_t new_used, size_t capacity);
+  // A container of length segments
+  void add_chain(uint length = 1)    { _chain_hist[chain_bucket(length)] += 1; }
+  // The chain of a container of length segments got one more
+  void extend_chain(uint length) {
+    _chain_hist[chain_bucket(length)] -= 1;
+    _chain_hist[chain_bucket(length + 1)] += 1;
+  }
+
+  // Adds the deltas of a gc thread and clears them
+  void fold(BDAFragmentationStats * deltas);
+
+  jlong  segments() const { return _segments; }
+  // The fraction of the segments left unused, and its variance, as the mean and
+  // variance of the fill ratio of the segments.
+  double mean_fragmentation() const;
+  double fragmentation_variance() const;
+
+  void print_histograms_on(outputStream * st) const;
+};
+
+inline void
+BDAFragmentationStats::add_segment(size_t used, size_t capacity)
+{
+  const double fill = fill_ratio(used, capacity);
+  _segments    += 1;
+  _fill_sum    += fill;
+  _fill_sq_sum += fill * fill;
+  _fill_hist[fill_bucket(fill)] += 1;
+}
+
+inline void
+BDAFragmentationStats::update_fill(size_t old_used, size_t new_used, size_t capacity)
+{
+  const double old_fill = fill_ratio(old_used, capacity);
+  const double new_fill = fill_ratio(new_used, capacity);
+  _fill_sum    += new_fill - old_fill;
+  _fill_sq_sum += new_fill * new_fill - old_fill * old_fill;
+  const int old_b = fill_bucket(old_fill);
+  const int new_b = fill_bucket(new_fill);
+  if (old_b != new_b) {
+    _fill_hist[old_b] -= 1;
+    _fill_hist[new_b] += 1;
+  }
+}
+
+#endif // SHARE_VM_BDA_BDASTATS_HPP
@@ -15,14 +15,14 @@ class ContainerOverflowTaskQueue : public OverflowTaskQueue<E, F, N>
 
   typedef MutableBDASpace::CGRPSpace * space_t;
 
-  inline void push_container(size_t size, space_t s);
+  inline void push_container(size_t size, space_t s, uint worker_id);
 };
 
 template<class E, MEMFLAGS F, unsigned int N>
 inline void
-ContainerOverflowTaskQueue<E, F, N>::push_container(size_t size, space_t s)
+ContainerOverflowTaskQueue<E, F, N>::push_container(size_t size, space_t s, uint worker_id)
 {
-  _collection = s->push_container(size);
+  _collection = s->push_container(size, worker_id);
 }
 
 template<class T, MEMFLAGS F>
@@ -1,5 +1,7 @@
 # include "bda/bdaTasks.hpp"
+# include "bda/bdaPhaseTimes.hpp"
 # include "gc_implementation/parallelScavenge/gcTaskManager.hpp"
+# include "gc_implementation/parallelScavenge/parallelScavengeHeap.hpp"
 # include "gc_implementation/parallelScavenge/psPromotionManager.hpp"
 # include "gc_implementation/parallelScavenge/psPromotionManager.inline.hpp"
 
@@ -11,16 +13,24 @@ void
 BDARefRootsTask::do_it(GCTaskManager * manager, uint which)
 {
   PSPromotionManager * pm = PSPromotionManager::gc_thread_promotion_manager(which);
-  Ref * r = NULL;
-  while((r = _refqueue->dequeue()) != NULL) {
-    // Ugly code ---
-    // FIXME: could this be better (and faster) is already implicit the kind of oop?
-    if(UseCompressedOops)
-      pm->process_dequeued_bdaroot<narrowOop>(r);
-    else
-      pm->process_dequeued_bdaroot<oop>(r);
-    pm->drain_bda_stacks();
+  BDAPhaseTimes * phase_times = _old_gen->bda_space()->phase_times();
+  BDAPhaseTimer timer(phase_times, BDAPhaseTimes::BDARefRoots, which);
+  RefBatch batch;
+  while(_refqueue->claim_batch(batch)) {
+    phase_times->add_work_items(BDAPhaseTimes::BDARefRoots, which,
+                                (size_t)(batch.end() - batch.begin()));
+    for (Ref * r = batch.begin(); r < batch.end(); ++r) {
+      // Ugly code ---
+      // FIXME: could this be better (and faster) is already implicit the kind of oop?
+      if(UseCompressedOops)
+        pm->process_dequeued_bdaroot<narrowOop>(r);
+      else
+        pm->process_dequeued_bdaroot<oop>(r);
+    }
+    // Keep some of the batch's contents in the stack, for the idle threads to steal.
+    pm->drain_bda_stacks(false);
   }
+  pm->drain_bda_stacks();
 }
 
 //
@@ -31,6 +41,9 @@ StealBDARefTask::do_it (GCTaskManager * manager, uint which)
 {
   PSPromotionManager * pm =
     PSPromotionManager::gc_thread_promotion_manager(which);
+  BDAPhaseTimes * phase_times =
+    ((ParallelScavengeHeap*)Universe::heap())->old_gen()->bda_space()->phase_times();
+  BDAPhaseTimer timer(phase_times, BDAPhaseTimes::StealBDARef, which);
   pm->drain_bda_stacks();
   guarantee (pm->bda_stacks_empty(), "bda stacks should be empty at this point");
 
@@ -38,6 +51,7 @@ StealBDARefTask::do_it (GCTaskManager * manager, uint which)
   while (true) {
     BDARefTask p;
     if (PSPromotionManager::bda_steal_depth (which, &random_seed, p)) {
+      phase_times->add_work_items(BDAPhaseTimes::StealBDARef, which, 1);
       if (UseCompressedOops)
         pm->process_popped_bdaref_depth<narrowOop>(p);
       else
@@ -60,59 +74,40 @@ OldToYoungBDARootsTask::do_it(GCTaskManager * manager, uint which)
 {
   assert (((MutableBDASpace*)_old_gen->object_space())->used_in_words() > 0, "Should not be called if there is no work.");
   assert (_old_gen->object_space() != NULL, "Sanity");
-  assert (_order_number < ParallelGCThreads, "Sanity");
 
   {
     PSPromotionManager * pm = PSPromotionManager::gc_thread_promotion_manager(which);
     MutableBDASpace * space = (MutableBDASpace*)_old_gen->object_space();
     assert (Universe::heap()->kind() == CollectedHeap::ParallelScavengeHeap, "Sanity");
     CardTableExtension * card_table = (CardTableExtension*)Universe::heap()->barrier_set();
+    BDAPhaseTimer timer(space->phase_times(), BDAPhaseTimes::OldToYoungBDARoots, which);
 
-    // Here we iterate through the bda spaces only, thus starting with the first which is in index 1
-    // on the array of spaces.
-    for (int spc_id = 0; spc_id < space->spaces()->length(); ++spc_id) {
-      MutableBDASpace::CGRPSpace * bda_space = space->spaces()->at(spc_id);
-      // This value is preferable to container_count > 0, because containers may have been alloc'd.
-      if (bda_space->last_before_gc() == NULL) continue;
-      container_t c = bda_space->get_previous_n_segment(bda_space->last_before_gc(), _order_number);
-      HeapWord * c_top; int j = 0;
-      while (c != NULL) {
+    // The chunks of the segments were snapshotted by save_tops_for_scavenge. Each thread
+    // claims them one at a time, so that the threads done with small segments help with
+    // the chunks of the large ones.
+    BDAScanChunk chunk;
+    while (space->claim_scan_chunk(chunk)) {
+      space->phase_times()->add_work_items(BDAPhaseTimes::OldToYoungBDARoots, which, 1);
+      container_t c = chunk.segment();
 #ifdef ASSERT
-        if (BDAPrintOldToYoungTasks && Verbose) {
-          gclog_or_tty->print_cr ("[%s] thread " INT32_FORMAT " scanning container "
-                                  PTR_FORMAT " with contents [" PTR_FORMAT ", " PTR_FORMAT ", "
-                                  PTR_FORMAT ") saved top " PTR_FORMAT " scanned by " INT32_FORMAT,
-                                  name(), which, (intptr_t)c,
-                                  (intptr_t)c->_start, (intptr_t)c->_top,
-                                  (intptr_t)c->_end, (intptr_t)c->_saved_top,
-                                  c->_scanned_flag);
-        }
-#endif // ASSERT
-        if (c->_saved_top == NULL || c->_start == c->_saved_top) {
-#ifdef ASSERT
-          if (BDAPrintOldToYoungTasks && Verbose) {
-            gclog_or_tty->print_cr ("[%s] thread " INT32_FORMAT " skipped container "
-                                    PTR_FORMAT,
-                                    name(), which, (intptr_t)c);
-          }
-#endif // ASSERT
-          c = bda_space->get_previous_n_segment(c, _batch_width);
-          continue;
-        }
-
-#ifdef ASSERT
-        assert (c->_scanned_flag == -1, "this segment was already scanned.");
-        c->_scanned_flag = (int)_order_number;
-#endif // ASSERT
-        assert (c->_start < c->_saved_top, "container or segment is empty allocated");
-        card_table->scavenge_bda_contents_parallel(_old_gen->start_array(),
-                                                   c,
-                                                   c->_saved_top,
-                                                   pm);
-        c = bda_space->get_previous_n_segment(c, _batch_width);
+      if (BDAPrintOldToYoungTasks && Verbose) {
+        gclog_or_tty->print_cr ("[%s] thread " INT32_FORMAT " scanning chunk ["
+                                PTR_FORMAT ", " PTR_FORMAT ") of container "
+                                PTR_FORMAT " with contents [" PTR_FORMAT ", " PTR_FORMAT ", "
+                                PTR_FORMAT ") saved top " PTR_FORMAT,
+                                name(), which,
+                                (intptr_t)chunk.beg(), (intptr_t)chunk.end(), (intptr_t)c,
+                                (intptr_t)c->_start, (intptr_t)c->_top,
+                                (intptr_t)c->_end, (intptr_t)c->_saved_top);
       }
-      pm->drain_bda_stacks();
+#endif // ASSERT
+      card_table->scavenge_bda_contents_parallel(_old_gen->start_array(),
+                                                 c,
+                                                 chunk.beg(),
+                                                 chunk.end(),
+                                                 pm);
     }
+    pm->drain_bda_stacks();
   }
 }
 
@@ -137,6 +132,7 @@ OldToYoungNonBDARootsTask::do_it(GCTaskManager * manager, uint which)
     PSPromotionManager * pm = PSPromotionManager::gc_thread_promotion_manager(which);
     assert (Universe::heap()->kind() == CollectedHeap::ParallelScavengeHeap, "Sanity");
     CardTableExtension * card_table = (CardTableExtension*)Universe::heap()->barrier_set();
+    BDAPhaseTimer timer(bda_space->phase_times(), BDAPhaseTimes::OldToYoungNonBDARoots, which);
 
     HeapWord * bottom = space->bottom();
 
@@ -154,7 +150,7 @@ OldToYoungNonBDARootsTask::do_it(GCTaskManager * manager, uint which)
       // We've reached the end of the space
       if (tmp_top == _gen_top) break;
       HeapWord * const new_bottom = bda_space->get_next_end_seg(tmp_top + 1, _gen_top) + 1;
-      assert (pointer_delta(new_bottom, bottom) >= MutableBDASpace::CGRPSpace::segment_sz ||
+      assert (pointer_delta(new_bottom, bottom) >= MutableBDASpace::MinRegionSize ||
               new_bottom > _gen_top,
               "incorrect size for the jumped segment");
       bottom = new_bottom;
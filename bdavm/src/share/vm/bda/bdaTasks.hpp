@@ -12,8 +12,9 @@
 //
 
 //
-// BDARefRootsTask tries to pop bda-refs from the refqueue and checks if each ref is
-// appropriate for promotion.
+// BDARefRootsTask claims batches of bda-refs from the refqueue and checks if each ref is
+// appropriate for promotion. Several tasks drain the refqueue in parallel, and the
+// contents left in their stacks feed the StealBDARefTasks.
 // 
 class BDARefRootsTask : public GCTask {
  private:
@@ -52,22 +53,20 @@ class StealBDARefTask : public GCTask
 };
 
 //
-// OldToYoungBDARootsTask iterates through the containers of all bda spaces and pushes
-// the contents of the oops to the bdaref_stack, for later direct promotion. It uses the
-// _gc_current value in each CGRPSpace (see mutableBDASpace.hpp) where it CAS the next value
-// and returns the pointer that was read.
+// OldToYoungBDARootsTask scans the dirty cards of the bda segments and pushes the contents
+// of the oops to the bdaref_stack, for later direct promotion. The segments are split in
+// chunks when the tops are saved (see MutableBDASpace::save_tops_for_scavenge) and each
+// task claims chunks until none are left.
 //
 class OldToYoungBDARootsTask : public GCTask
 {
 
  private:
   PSOldGen * _old_gen;
-  uint       _batch_width;
-  uint       _order_number;
 
  public:
-  OldToYoungBDARootsTask(PSOldGen * old_gen, uint order_number, uint batch_width) :
-    _old_gen(old_gen), _order_number (order_number), _batch_width (batch_width) { }
+  OldToYoungBDARootsTask(PSOldGen * old_gen) :
+    _old_gen(old_gen) { }
 
   char * name() { return (char*)"big-data old to young roots task"; }
 
@@ -1,11 +1,16 @@
 # include "bda/mutableBDASpace.inline.hpp"
+# include "bda/bdaCounters.hpp"
+# include "bda/bdaPhaseTimes.hpp"
 # include "gc_implementation/shared/spaceDecorator.hpp"
 # include "gc_implementation/parallelScavenge/parallelScavengeHeap.hpp"
 # include "gc_implementation/parallelScavenge/psParallelCompact.hpp"
+# include "gc_implementation/parallelScavenge/psYoungGen.hpp"
+# include "gc_implementation/shared/mutableNUMASpace.hpp"
 # include "memory/resourceArea.hpp"
 # include "runtime/thread.hpp"
 # include "runtime/vmThread.hpp"
 # include "runtime/java.hpp"
+# include "runtime/safepoint.hpp"
 # include "oops/oop.inline.hpp"
 # include "oops/klassRegionMap.hpp"
 
@@ -49,60 +54,69 @@ container_t
 MutableBDASpace::CGRPSpace::allocate_and_setup_container(HeapWord * start,
                                                          size_t reserved_sz, size_t obj_sz)
 {
-  container_t container = allocate_container();
+  container_t container = allocate_container(start);
   setup_container (container, MemRegion(start, reserved_sz), obj_sz);
   return container;
 }
 
 container_t
-MutableBDASpace::CGRPSpace::allocate_container()
+MutableBDASpace::CGRPSpace::allocate_container(HeapWord * start)
 {
-  // We allocate it with the general AllocateHeap since struct is not, by default,
-  // subclass of one of the base VM classes (CHeap, ResourceObj, ... and friends).
-  // It must be initialized prior to allocation because there's no default constructor.
-  container_t container = (container_t)AllocateHeap(sizeof(struct container), mtGC);
-  return container;
+  // The descriptors are not allocated one by one, but taken from the side table of
+  // the manager, so the descriptor of any segment can be computed from its start.
+  return _manager->descriptor_at(start);
 }
 
 container_t
-MutableBDASpace::CGRPSpace::allocate_large_container(size_t size)
+MutableBDASpace::CGRPSpace::install_segment(HeapWord * ptr, size_t reserved_sz, size_t size)
 {
-  size_t reserved_sz = calculate_large_reserved_sz(size);
-  container_t container = install_container_in_space(reserved_sz, size);
-  // Here, the container pointer is installed on the RegionData object that manages
-  // the address range this container spans during OldGC. This is for fast access
-  // during summarize and update of the containers top pointers.
-  if (container != NULL) {
-    _manager->mark_container(container);
-    _manager->allocate_block(container->_start);
-    PSParallelCompact::install_container_in_region(container);
-    if (BDAllocationVerboseLevel > 1) {
-      print_allocation(container, true);
+  // The descriptors of the slots the segment spans may have been left in the pool
+  // by the last OldGC. The first one now describes the segment, the others are unused.
+  for (HeapWord * p = ptr; p < ptr + reserved_sz; p += MutableBDASpace::MinRegionSize) {
+    container_t temp = _manager->descriptor_at(p);
+    if (!not_in_pool(temp)) {
+      remove_from_pool(temp);
     }
   }
-  
-  return container;
+  return allocate_and_setup_container(ptr, reserved_sz, size);
 }
 
 container_t
-MutableBDASpace::CGRPSpace::push_container(size_t size)
+MutableBDASpace::CGRPSpace::push_container(size_t size, uint worker_id, size_t min_reserved_sz,
+                                           int node)
 {
   container_t container;
-  container_t first_seg;
-  container_t last_seg;
   HeapWord * ptr;
-  size_t reserved_sz = segment_sz;
+  size_t reserved_sz = _segment_sz;
+
+  if (node == any_numa_node) {
+    node = _manager->current_numa_node();
+  }
 
   // Objects bigger than this size are, generally, large arrays.
-  // Get the aligned reserved size, multiple of segment_sz.
-  if (size > segment_sz) {
+  // Get the aligned reserved size, multiple of MinRegionSize.
+  if (size > reserved_sz) {
     reserved_sz = calculate_large_reserved_sz(size);
   }
+  if (min_reserved_sz > reserved_sz) {
+    reserved_sz = calculate_large_reserved_sz(min_reserved_sz);
+  }
 
   if (container_type() != KlassRegionMap::region_start_ptr()) {
-    // Now the amount of space is reserved with a CAS and the resulting ptr
-    // will be returned as the start of the collection struct.
-    ptr = space()->cas_allocate(reserved_sz);
+    // Regular segments are taken from the run of segments cached by the gc thread,
+    // so the top of the space is only CASed once per run. Large segments are
+    // reserved directly, with a CAS.
+    if (reserved_sz == _segment_sz) {
+      ptr = claim_segment(worker_id, node);
+    } else {
+      ptr = space()->cas_allocate(reserved_sz);
+      if (ptr == NULL) {
+        ptr = claim_spill(reserved_sz);
+      }
+      if (ptr != NULL) {
+        _manager->bias_segments(ptr, reserved_sz, node);
+      }
+    }
     
     // If there's no space left to allocate a new container, then
     // return NULL so that MutableBDASpace can handle the allocation
@@ -110,48 +124,8 @@ MutableBDASpace::CGRPSpace::push_container(size_t size)
     if (ptr == NULL) {
       return (container_t)ptr;
     }
-  
-    // Get the container/segment in the RegionData that spans the addressable space
-    container = PSParallelCompact::get_container_at_addr(ptr);
-    last_seg  = PSParallelCompact::get_container_at_addr(ptr + reserved_sz);
-    first_seg = container;
-
-    // If there is a container/segment, then use this one, setting the limits accordingly
-    if (container != NULL) {
-      // Remove from the pool by decreasing the num of elements.
-      _pool->phantom_remove();
-
-      // This block follows these sequence of rules:
-      //   a) if the thread grabbed a segment whose start is below ptr then it tries to grab
-      //      the adjacent segment, still owned by the reserved space of the thread;
-      //   b) if this condition is not satisfied it means that the thread may be grabbing
-      //      a segment belonging to a different thread. Therefore, allocates a new one.
-      if (container->_start != ptr) {
-        container_t temp;
-        temp = PSParallelCompact::get_container_at_addr(ptr + reserved_sz - 1);
-        if (temp != container)
-          container = temp;
-        else
-          container = allocate_container();
-      }
-  
-      // Free unused segments in between and only those that are not going to be touched
-      // by other threads.
-      for (HeapWord * p = ptr + segment_sz; p < ptr + reserved_sz; p += segment_sz) {
-        container_t temp;
-        temp = PSParallelCompact::get_container_at_addr(p);
-        if (temp != container && temp != first_seg && temp != last_seg) {
-          // TODO: Is this really necessary? Aren't those containers/segments already
-          // in the pool, thus freed?
-          free_container(temp);
-        }
-      }
 
-      // Setup the container last
-      setup_container(container, MemRegion(ptr, reserved_sz), size);
-    } else {
-      container = allocate_and_setup_container(ptr, reserved_sz, size);
-    }
+    container = install_segment(ptr, reserved_sz, size);
   } else {
     // The amount of space is reserved with a CAS, but it must be aligned with the 512 byte blocks
     // on the card table.
@@ -163,24 +137,20 @@ MutableBDASpace::CGRPSpace::push_container(size_t size)
       return (container_t)ptr;
     }
 
-    // Get a queued container from the pool or allocate a new one
-    container = _pool->dequeue();
-    if (container != NULL) {
-      setup_container(container, MemRegion(ptr, reserved_sz), size);
-    } else {
-      container = allocate_and_setup_container(ptr, reserved_sz, size);
-    }
+    _manager->bias_segments(ptr, reserved_sz, node);
+    container = allocate_and_setup_container(ptr, reserved_sz, size);
   }
 
   // Add to the queue
   if (container != NULL) {
+    container->_numa_node = (int8_t)node;
     assert (container->_next_segment == NULL, "should have been reset");
     assert (container->_prev_segment == NULL, "should have been reset");
     assert (container->_next == NULL, "should have been reset");
     assert (container->_previous == NULL, "should have been reset");
-#ifdef ASSERT
-    _segments_since_last_gc++;
-#endif
+    Atomic::inc(&_segments_since_last_gc);
+    frag_deltas(worker_id)->add_segment(pointer_delta(container->_top, container->_start),
+                                        pointer_delta(container->_end, container->_start));
     // MT safe, but only for subsequent enqueues/dequeues. If mixed, then the queue may break!
     // See gen_queue.hpp for more details.
     _containers->enqueue(container);
@@ -189,15 +159,242 @@ MutableBDASpace::CGRPSpace::push_container(size_t size)
   return container;
 }
 
+container_t
+MutableBDASpace::CGRPSpace::push_region_container(size_t size)
+{
+  assert (SafepointSynchronize::is_at_safepoint(), "must be at a safepoint");
+  assert (size <= MutableBDASpace::MinRegionSize - MutableBDASpace::_filler_header_size,
+          "the region does not fit in a slot");
+
+  // The caches of the gc threads are empty, since they are retired before the
+  // summary, so the segment is taken from the top of the space.
+  HeapWord * ptr = space()->cas_allocate(MutableBDASpace::MinRegionSize);
+  if (ptr == NULL) {
+    return NULL;
+  }
+
+  container_t container = install_segment(ptr, MutableBDASpace::MinRegionSize, size);
+  Atomic::inc(&_segments_since_last_gc);
+  _containers->enqueue_no_mt(container);
+  return container;
+}
+
+HeapWord *
+MutableBDASpace::CGRPSpace::claim_segment(uint worker_id, int node)
+{
+  assert (node >= 0 && node < _manager->numa_nodes(), "node out of range");
+  const uint cache_id = worker_id * _manager->numa_nodes() + node;
+  assert (cache_id < _n_caches, "worker id out of range");
+  SegmentCache * const cache = &_caches[cache_id];
+  HeapWord * ptr = cache->claim(_segment_sz);
+
+  if (ptr == NULL) {
+    // The run is exhausted: reserve a new one with a single CAS, but fall back to
+    // a single segment when the space is almost full.
+    const size_t run_sz = MAX2(BDASegmentCacheSize, (uintx)1) * _segment_sz;
+    HeapWord * run = run_sz > _segment_sz ? space()->cas_allocate(run_sz) : NULL;
+    if (run != NULL) {
+      cache->set_run(run + _segment_sz, run + run_sz);
+      ptr = run;
+      _manager->bias_segments(run, run_sz, node);
+    } else {
+      ptr = space()->cas_allocate(_segment_sz);
+      if (ptr == NULL) {
+        ptr = claim_spill(_segment_sz);
+      }
+      if (ptr != NULL) {
+        _manager->bias_segments(ptr, _segment_sz, node);
+      }
+    }
+  }
+  return ptr;
+}
+
+HeapWord *
+MutableBDASpace::CGRPSpace::claim_spill(size_t sz)
+{
+  do {
+    HeapWord * const cur = _spill_top;
+    if (pointer_delta(_spill_end, cur) < sz) {
+      return NULL;
+    }
+    if (Atomic::cmpxchg_ptr(cur + sz, &_spill_top, cur) == cur) {
+      return cur;
+    }
+  } while (true);
+}
+
+void
+MutableBDASpace::CGRPSpace::add_spill(HeapWord * beg)
+{
+  assert (SafepointSynchronize::is_at_safepoint(), "must be at a safepoint");
+  HeapWord * const bottom = space()->bottom();
+  assert (beg < bottom && (pointer_delta(bottom, beg) & MutableBDASpace::MinRegionSizeOffsetMask) == 0,
+          "the spill must span whole slots below the space");
+
+  // A spill already claimed from is not contiguous with the new one. What is left of
+  // it goes to the cache of a gc thread, if it spans whole segments and one is free.
+  if (_spill_top != _spill_end && _spill_top != bottom && !cache_spill()) {
+    retire_spill();
+  }
+  if (_spill_top == _spill_end) {
+    _spill_end = bottom;
+  }
+  _spill_top = beg;
+}
+
+void
+MutableBDASpace::CGRPSpace::retire_spill()
+{
+  assert (SafepointSynchronize::is_at_safepoint(), "must be at a safepoint");
+
+  // As the runs of the caches, the spill lies below segments in use.
+  for (HeapWord * p = _spill_top; p < _spill_end; ) {
+    const size_t sz = MIN2(_segment_sz, pointer_delta(_spill_end, p));
+    container_t c = install_segment(p, sz, 0);
+    _containers->enqueue_no_mt(c);
+    // The gc threads are idle, so the stats of the space take the segment directly
+    _frag_stats.add_segment(0, pointer_delta(c->_end, c->_start));
+    _frag_stats.add_chain();
+    p += sz;
+  }
+  _spill_top = _spill_end = NULL;
+}
+
+bool
+MutableBDASpace::CGRPSpace::cache_spill()
+{
+  assert (SafepointSynchronize::is_at_safepoint(), "must be at a safepoint");
+  const size_t words = spill_free_in_words();
+  if (words % _segment_sz != 0) {
+    return false;
+  }
+  for (uint i = 0; i < _n_caches; i++) {
+    SegmentCache * const cache = &_caches[i];
+    if (cache->is_empty()) {
+      _manager->bias_segments(_spill_top, words, (int)(i % _manager->numa_nodes()));
+      cache->set_run(_spill_top, _spill_end);
+      _spill_top = _spill_end = NULL;
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t
+MutableBDASpace::CGRPSpace::cached_free_in_words() const
+{
+  size_t words = 0;
+  for (uint i = 0; i < _n_caches; i++) {
+    words += pointer_delta(_caches[i].end(), _caches[i].cur());
+  }
+  return words;
+}
+
+void
+MutableBDASpace::CGRPSpace::release_pool(HeapWord * beg, HeapWord * end)
+{
+  for (HeapWord * p = beg; p < end; p += MutableBDASpace::MinRegionSize) {
+    container_t c = _manager->descriptor_at(p);
+    if (!not_in_pool(c)) {
+      remove_from_pool(c);
+    }
+  }
+}
+
+size_t
+MutableBDASpace::CGRPSpace::reserved_words() const
+{
+  return pointer_delta(space()->top(), space()->bottom()) - spill_free_in_words() -
+    cached_free_in_words();
+}
+
+void
+MutableBDASpace::CGRPSpace::sample_reserved_words()
+{
+  assert (SafepointSynchronize::is_at_safepoint(), "must be at a safepoint");
+  const size_t reserved = reserved_words();
+  // The words taken only drop at full GC, which restarts the sampling
+  if (reserved >= _reserved_at_last_gc) {
+    _avg_reserved->sample((float)(reserved - _reserved_at_last_gc));
+  }
+  _reserved_at_last_gc = reserved;
+}
+
+void
+MutableBDASpace::CGRPSpace::retract_segment_caches()
+{
+  assert (SafepointSynchronize::is_at_safepoint(), "must be at a safepoint");
+
+  // The runs that end at the top of the space are given back to it, the most
+  // recently reserved first, since the one below may end at the new top.
+  bool retracted;
+  do {
+    retracted = false;
+    for (uint i = 0; i < _n_caches; i++) {
+      SegmentCache * const cache = &_caches[i];
+      if (!cache->is_empty() && cache->end() == space()->top()) {
+        space()->set_top(cache->cur());
+        cache->reset();
+        retracted = true;
+      }
+    }
+  } while (retracted);
+}
+
+void
+MutableBDASpace::CGRPSpace::retire_segment_caches()
+{
+  retract_segment_caches();
+
+  // The remaining runs lie below segments in use. Their segments become empty
+  // containers, so the space has no holes, and the full gc returns them to the
+  // pool. The runs may have been reserved with another segment size.
+  for (uint i = 0; i < _n_caches; i++) {
+    SegmentCache * const cache = &_caches[i];
+    for (HeapWord * p = cache->cur(); p < cache->end(); ) {
+      const size_t sz = MIN2(_segment_sz, pointer_delta(cache->end(), p));
+      container_t c = install_segment(p, sz, 0);
+      c->_numa_node = (int8_t)(i % _manager->numa_nodes());
+      _containers->enqueue_no_mt(c);
+      _frag_stats.add_segment(0, pointer_delta(c->_end, c->_start));
+      _frag_stats.add_chain();
+      p += sz;
+    }
+    cache->reset();
+  }
+}
+
 HeapWord *
-MutableBDASpace::CGRPSpace::allocate_new_segment (size_t size, container_t& c)
+MutableBDASpace::CGRPSpace::allocate_new_segment (size_t size, container_t& c, uint worker_id)
 {
-  container_t container = push_container(size);
+  container_t container = NULL;
   container_t next,last; 
+
+  // A container that keeps growing gets segments twice as large as its last one,
+  // so that its chain of segments stays short. Fall back to a regular segment
+  // if the space cannot fit the larger one.
+  // The new segment stays on the node of the container
+  const int node = c->_numa_node;
+  if (BDAAdaptiveSegmentSize && container_type() != KlassRegionMap::region_start_ptr()) {
+    const size_t grown_sz = MIN2(2 * pointer_delta(c->_hard_end, c->_start),
+                                 max_segment_size());
+    if (grown_sz > _segment_sz) {
+      container = push_container(size, worker_id, grown_sz, node);
+    }
+  }
+  if (container == NULL) {
+    container = push_container(size, worker_id, 0, node);
+  }
   
   if (container != NULL) {
+    Atomic::inc(&_extensions_since_last_gc);
     last = c; next = last->_next_segment;
     do {
+      // The position is set before the segment is linked, so that a thread racing
+      // to extend the chain finds it.
+      container->_chain_space_id = last->_chain_space_id;
+      container->_chain_pos = (uint16_t)MIN2(last->_chain_pos + 1, (int)max_chain_pos);
       if (next == NULL && Atomic::cmpxchg_ptr(container,
                                               &(last->_next_segment),
                                               next) == next) {
@@ -208,6 +405,7 @@ MutableBDASpace::CGRPSpace::allocate_new_segment (size_t size, container_t& c)
     } while (true);
     
     container->_prev_segment = last;
+    _manager->spaces()->at((int)last->_chain_space_id)->frag_deltas(worker_id)->extend_chain(last->_chain_pos);
     // For the return val of the callee
     c = container;
     return container->_start;
@@ -224,10 +422,10 @@ MutableBDASpace::CGRPSpace::setup_container(container_t& container, MemRegion mr
   container->_end = mr.end() - MutableBDASpace::_filler_header_size;
   container->_next_segment = NULL; container->_next = NULL; container->_prev_segment = NULL;
   container->_previous = NULL; container->_saved_top = NULL;
-  container->_space_id = (char)(exact_log2((intptr_t) _type->value()));
-#ifdef ASSERT
-  container->_scanned_flag = -1;
-#endif
+  container->_space_id = (uint16_t)space_id();
+  container->_numa_node = 0;
+  container->_chain_space_id = container->_space_id;
+  container->_chain_pos = 1;
 
   // Here, the container pointer is installed on the RegionData object that manages
   // the address range this container spans during OldGC. This is for fast access
@@ -302,6 +500,29 @@ MutableBDASpace::CGRPSpace::oop_iterate_no_header_containers(OopClosure * cl)
   }
 }
 
+jint
+MutableBDASpace::CGRPSpace::scan_chunks(BDAScanChunk * chunks, size_t chunk_words) const
+{
+  jint n = 0;
+  if (container_count() > 0) {
+    for (GenQueueIterator<container_t, mtGC> iterator = _containers->iterator();
+         *iterator != NULL;
+         ++iterator) {
+      container_t c = *iterator;
+      // Segments saved as empty have no old-to-young refs (see save_top_ptrs)
+      if (c->_saved_top == NULL || c->_start == c->_saved_top) continue;
+      for (HeapWord * beg = c->_start; beg < c->_saved_top; beg += chunk_words) {
+        if (chunks != NULL) {
+          HeapWord * end = beg + MIN2(chunk_words, pointer_delta(c->_saved_top, beg));
+          chunks[n] = BDAScanChunk(c, beg, end);
+        }
+        ++n;
+      }
+    }
+  }
+  return n;
+}
+
 void
 MutableBDASpace::CGRPSpace::verify()
 {
@@ -340,51 +561,67 @@ MutableBDASpace::CGRPSpace::verify_segments_othergen() const
 }
 #endif
 
+double
+MutableBDASpace::CGRPSpace::container_fragmentation(double * var) const
+{
+  if (var != NULL) {
+    *var = _frag_stats.fragmentation_variance();
+  }
+  return _frag_stats.mean_fragmentation();
+}
+
 void
-MutableBDASpace::CGRPSpace::print_container_fragmentation_stats() const
+MutableBDASpace::CGRPSpace::fold_fragmentation_stats()
 {
-  double avg = 0.0;
-  double var = 0.0;
-  double dev = 0.0;
-  int    i   = 1;
+  assert (SafepointSynchronize::is_at_safepoint(), "must be at a safepoint");
+  for (uint i = 0; i < ParallelGCThreads + 1; i++) {
+    _frag_stats.fold(&_frag_deltas[i]);
+  }
+}
+
+void
+MutableBDASpace::CGRPSpace::recompute_fragmentation_stats()
+{
+  assert (SafepointSynchronize::is_at_safepoint(), "must be at a safepoint");
+  _frag_stats.reset();
+  for (uint i = 0; i < ParallelGCThreads + 1; i++) {
+    _frag_deltas[i].reset();
+  }
+
   for (GenQueueIterator<container_t, mtGC> it = _containers->iterator();
        *it != NULL;
        ++it )
   {
     container_t const c = *it;
-    HeapWord *  const bot = c->_start;
-    HeapWord *  const top = c->_top;
-    HeapWord *  const end = c->_end;
-
-    // Compute fragmentation for this segment
-    double frag = 1 - (pointer_delta (top, bot) / (double)pointer_delta (end, bot));
-    
-    // Compute the average segment fragmentation and variance.
-    // Both the average and the variance are calculated using the
-    // incremental method in a similar fashion to what Donald Knuth presents of
-    // B. P. Welford's method.
-
-    double const old_avg = avg;
-
-    avg += (frag - old_avg) / i;
-
-    // Don't compute variance if i < 2
-    if ( i > 1 ) {
-      var += (frag - old_avg) * (frag - avg);
+    _frag_stats.add_segment(pointer_delta(c->_top, c->_start),
+                            pointer_delta(c->_end, c->_start));
+    // The chains are counted, and their segments numbered, from their first one,
+    // since their segments may be in other spaces.
+    if (c->_prev_segment == NULL) {
+      uint32_t pos = 0;
+      for (container_t seg = c; seg != NULL; seg = seg->_next_segment) {
+        seg->_chain_space_id = c->_space_id;
+        seg->_chain_pos = (uint16_t)MIN2(++pos, (uint32_t)max_chain_pos);
+      }
+      _frag_stats.add_chain(pos);
     }
-
-    i++;
   }
+}
 
-  var /= i - 1;
-  dev = sqrt(var);
+void
+MutableBDASpace::CGRPSpace::print_container_fragmentation_stats() const
+{
+  double var = 0.0;
+  double avg = container_fragmentation(&var);
+  double dev = sqrt(var);
   
   // Print the statistical information
-  gclog_or_tty->print_cr("Space " INT32_FORMAT, exact_log2((intptr_t)container_type()->value()));
+  gclog_or_tty->print_cr("Space " INT32_FORMAT, space_id());
   gclog_or_tty->print_cr("  Average fragmentation = %f%%", avg * (float)100);
   gclog_or_tty->print_cr("  Variance in fragmentation = %f", var);
   gclog_or_tty->print_cr("  Standard Deviation in fragmentation = %f", dev);
   gclog_or_tty->print_cr("  Number of segments in space = " INT32_FORMAT, container_count());
+  _frag_stats.print_histograms_on(gclog_or_tty);
 }
 
 void
@@ -400,11 +637,36 @@ MutableBDASpace::CGRPSpace::print_allocation(container_t c, bool large) const
                          c->_start, c->_end);
 }
 
+void
+MutableBDASpace::CGRPSpace::used_per_numa_node(size_t * words) const
+{
+  if (container_count() > 0) {
+    for (GenQueueIterator<container_t, mtGC> iterator = _containers->iterator();
+         *iterator != NULL;
+         ++iterator) {
+      container_t c = *iterator;
+      assert (c->_numa_node >= 0 && c->_numa_node < _manager->numa_nodes(), "node out of range");
+      words[c->_numa_node] += pointer_delta(c->_top, c->_start);
+    }
+  }
+}
+
 void
 MutableBDASpace::CGRPSpace::print_allocation_stats(outputStream * st) const
 {  
   st->print_cr(" %-25s Space ID = " INT32_FORMAT " allocated " INT32_FORMAT " segments during GC]",
-               "--[BDA Alloc Stats ::", this->container_type()->value(), _segments_since_last_gc);
+               "--[BDA Alloc Stats ::", space_id(), _segments_since_last_gc);
+  const int nodes = _manager->numa_nodes();
+  if (nodes > 1) {
+    ResourceMark rm;
+    size_t * words = NEW_RESOURCE_ARRAY(size_t, nodes);
+    memset(words, 0, nodes * sizeof(size_t));
+    used_per_numa_node(words);
+    for (int i = 0; i < nodes; ++i) {
+      st->print_cr("   Node " INT32_FORMAT " (lgrp " INT32_FORMAT "): used " SIZE_FORMAT "K",
+                   i, _manager->numa_lgrp_id(i), words[i] * HeapWordSize / K);
+    }
+  }
 }
 
 void
@@ -417,7 +679,7 @@ MutableBDASpace::CGRPSpace::print_used(outputStream * st) const
 
   st->print   ("\n");
   st->print_cr(" --[%-20s Space ID = " INT32_FORMAT " containers :]",
-               "BDA Containers on", container_type()->value());
+               "BDA Containers on", space_id());
   for (GenQueueIterator<container_t, mtGC> it = _containers->iterator();
        *it != NULL;
        ++it )
@@ -465,6 +727,60 @@ void
 MutableBDASpace::CGRPSpace::reset_stats()
 {
   _segments_since_last_gc = 0;
+  _extensions_since_last_gc = 0;
+}
+
+void
+MutableBDASpace::CGRPSpace::resize_segments()
+{
+  assert (SafepointSynchronize::is_at_safepoint(), "must be at a safepoint");
+  const jint segments   = _segments_since_last_gc;
+  const jint extensions = _extensions_since_last_gc;
+  const jint containers = segments - extensions;
+  const size_t old_sz   = _segment_sz;
+
+  if (segments == 0) {
+    return;
+  }
+
+  if (extensions > containers) {
+    // On average, each new container needed more than one extra segment.
+    _segment_sz = MIN2(2 * _segment_sz, max_segment_size());
+    _quiet_gcs = 0;
+  } else if (extensions == 0 && ++_quiet_gcs >= 2) {
+    // No container outgrew its segment in the last GCs. Shrink the segments if
+    // the containers that fit in a single one fill less than half of it.
+    size_t used = 0;
+    size_t count = 0;
+    for (GenQueueIterator<container_t, mtGC> it = _containers->iterator();
+         *it != NULL;
+         ++it) {
+      container_t c = *it;
+      if (c->_prev_segment == NULL && c->_next_segment == NULL &&
+          pointer_delta(c->_hard_end, c->_start) == _segment_sz) {
+        used += pointer_delta(c->_top, c->_start);
+        count++;
+      }
+    }
+    if (count > 0 && used / count < _segment_sz / 2) {
+      _segment_sz = MAX2(_segment_sz / 2, MutableBDASpace::MinRegionSize);
+    }
+    _quiet_gcs = 0;
+  } else if (extensions > 0) {
+    _quiet_gcs = 0;
+  }
+
+  // The runs cached by the gc threads hold segments of the old size
+  if (_segment_sz != old_sz) {
+    retire_segment_caches();
+  }
+
+  if (BDAllocationVerboseLevel > 0 && _segment_sz != old_sz) {
+    gclog_or_tty->print_cr("--[BDA Segment Size :: Space ID = " INT32_FORMAT " "
+                           SIZE_FORMAT "K -> " SIZE_FORMAT "K]",
+                           space_id(),
+                           old_sz * HeapWordSize / K, _segment_sz * HeapWordSize / K);
+  }
 }
 
 #ifdef ASSERT
@@ -472,8 +788,7 @@ void
 MutableBDASpace::CGRPSpace::print_container_contents(outputStream * st) const
 {
   assert ( container_count() > 0, "Shouldn't be possible" );
-  st->print_cr ("%-30s " INT32_FORMAT, "Containers Segments for Space",
-                exact_log2((intptr_t)container_type()->value()));
+  st->print_cr ("%-30s " INT32_FORMAT, "Containers Segments for Space", space_id());
   {
     ResourceMark rm;
     
@@ -509,8 +824,7 @@ void
 MutableBDASpace::CGRPSpace::verbose_print_all_containers (outputStream * st) const
 {
   assert ( container_count() > 0, "Should not be possible." );
-  st->print_cr ("%-30s " INT32_FORMAT, "Segment chain for Space",
-                exact_log2((intptr_t)container_type()->value()));
+  st->print_cr ("%-30s " INT32_FORMAT, "Segment chain for Space", space_id());
 
   for (GenQueueIterator<container_t, mtGC> it = _containers->iterator();
        *it != NULL;
@@ -543,6 +857,35 @@ MutableBDASpace::MutableBDASpace(size_t alignment, ObjectStartArray * start_arra
   _spaces = new (ResourceObj::C_HEAP, mtGC) GrowableArray<CGRPSpace*>(n_regions, true);
   _page_size = os::vm_page_size();
   _start_array = start_array;
+  _descriptors = NULL;
+  _descriptors_base = NULL;
+  _descriptors_len = 0;
+  _scan_chunks = NULL;
+  _scan_chunks_capacity = 0;
+  _n_scan_chunks = 0;
+  _next_scan_chunk = 0;
+  _shrink_wanted = 0;
+  _counters = NULL;
+  _phase_times = new BDAPhaseTimes(ParallelGCThreads);
+
+  // The node of the thread that allocated a root is told from the eden chunk it is in,
+  // hence the placement needs the eden split among the nodes.
+  _numa_lgrp_ids = NULL;
+  _numa_nodes = 1;
+  if (BDANUMAPlacement && UseNUMA) {
+    const size_t lgrp_limit = MIN2(os::numa_get_groups_num(), (size_t)max_jbyte);
+    if (lgrp_limit > 1) {
+      _numa_lgrp_ids = NEW_C_HEAP_ARRAY(int, lgrp_limit, mtGC);
+      _numa_nodes = (int)os::numa_get_leaf_groups(_numa_lgrp_ids, lgrp_limit);
+    }
+    if (_numa_nodes <= 1) {
+      if (_numa_lgrp_ids != NULL) {
+        FREE_C_HEAP_ARRAY(int, _numa_lgrp_ids, mtGC);
+        _numa_lgrp_ids = NULL;
+      }
+      _numa_nodes = 1;
+    }
+  }
 
   // Initialize these to the values on the launch args
   CGRPSpace::dnf = BDAElementNumberFields;
@@ -557,11 +900,9 @@ MutableBDASpace::MutableBDASpace(size_t alignment, ObjectStartArray * start_arra
   // The number of regions must always include at least one region (the general one).
   // It is implied that the KlassRegionMap must be initialized before since it parses
   // the BDAKlasses string.
-  BDARegion* region = KlassRegionMap::region_start_ptr();
-  spaces()->append(new CGRPSpace(alignment, region, this)); ++region;
-  for(int i = 1; i < n_regions; i++)  {
-    spaces()->append(new CGRPSpace(alignment, region, this));
-    region += 2;
+  // The space of each region is at its space id, see BDARegion.
+  for(int i = 0; i < n_regions; i++)  {
+    spaces()->append(new CGRPSpace(alignment, KlassRegionMap::region_for_space(i), this));
   }
 }
 
@@ -570,6 +911,19 @@ MutableBDASpace::~MutableBDASpace() {
     delete spaces()->at(i);
   }
   delete spaces();
+  if (_descriptors != NULL) {
+    FREE_C_HEAP_ARRAY(struct container, _descriptors, mtGC);
+  }
+  if (_scan_chunks != NULL) {
+    FREE_C_HEAP_ARRAY(BDAScanChunk, _scan_chunks, mtGC);
+  }
+  if (_numa_lgrp_ids != NULL) {
+    FREE_C_HEAP_ARRAY(int, _numa_lgrp_ids, mtGC);
+  }
+  if (_counters != NULL) {
+    delete _counters;
+  }
+  delete _phase_times;
 }
 
 void
@@ -604,13 +958,19 @@ MutableBDASpace::post_initialize()
   ParallelScavengeHeap * heap = ParallelScavengeHeap::heap();
   MemRegion reserved = heap->reserved_region();
   
-  if (!_segment_bitmap.initialize(reserved)) {
-    vm_shutdown_during_initialization(
-      err_msg("Unable to allocate " SIZE_FORMAT "KB bitmaps for segment processing in "
-              "garbage collection for the requested " SIZE_FORMAT "KB heap.",
-              _segment_bitmap.reserved_byte_size()/K, reserved.byte_size()/K));
-    return false;
-  }
+  // The descriptor table and the segment bitmaps span the reserved heap, one slot each
+  assert (CGRPSpace::segment_sz >= MinRegionSize, "segments must span at least a slot");
+  // The bda summary of the card table has one entry per slot
+  assert (CardTableModRefBS::bda_summary_shift == (int)(Log2MinRegionSize + LogHeapWordSize),
+          "the bda summary must have the granularity of a slot");
+  assert (is_ptr_aligned(reserved.start(), MinRegionSize * HeapWordSize),
+          "slots must be aligned with the entries of the bda summary");
+  _descriptors_base = reserved.start();
+  _descriptors_len = align_size_up(reserved.word_size(), MinRegionSize) >> Log2MinRegionSize;
+  _descriptors = NEW_C_HEAP_ARRAY(struct container, _descriptors_len, mtGC);
+  memset(_descriptors, 0, _descriptors_len * sizeof(struct container));
+  _segment_beg_slots.resize(_descriptors_len, false);
+  _segment_end_slots.resize(_descriptors_len, false);
 
   // Update the filler_header_size
   _filler_header_size = align_object_size(typeArrayOopDesc::header_size(T_INT));
@@ -618,6 +978,58 @@ MutableBDASpace::post_initialize()
   return true;
 }
 
+int
+MutableBDASpace::numa_node_for_lgrp(int lgrp_id) const
+{
+  for (int i = 0; i < _numa_nodes; ++i) {
+    if (_numa_lgrp_ids[i] == lgrp_id) {
+      return i;
+    }
+  }
+  return 0;
+}
+
+int
+MutableBDASpace::current_numa_node() const
+{
+  if (_numa_nodes == 1) return 0;
+  return numa_node_for_lgrp(os::numa_get_group_id());
+}
+
+int
+MutableBDASpace::numa_node_of(oop root) const
+{
+  if (_numa_nodes == 1) return 0;
+  // Threads allocate in the eden chunk of their own node (see MutableNUMASpace). The
+  // roots that survived a scavenge have lost their node and take the gc thread's.
+  MutableNUMASpace * eden =
+    (MutableNUMASpace*)ParallelScavengeHeap::heap()->young_gen()->eden_space();
+  if (eden->contains(root)) {
+    for (int i = 0; i < eden->lgrp_spaces()->length(); ++i) {
+      if (eden->lgrp_spaces()->at(i)->space()->contains(root)) {
+        return numa_node_for_lgrp(eden->lgrp_spaces()->at(i)->lgrp_id());
+      }
+    }
+  }
+  return current_numa_node();
+}
+
+void
+MutableBDASpace::bias_segments(HeapWord * ptr, size_t sz, int node) const
+{
+  if (_numa_nodes == 1) return;
+  assert (node >= 0 && node < _numa_nodes, "node out of range");
+  // As in MutableNUMASpace::bias_region, the pages are freed so that they are
+  // touched again on the node. Only the pages within the range are biased.
+  HeapWord * start = (HeapWord*)round_to((intptr_t)ptr, page_size());
+  HeapWord * end = (HeapWord*)round_down((intptr_t)(ptr + sz), page_size());
+  if (end > start) {
+    const size_t bytes = pointer_delta(end, start, sizeof(char));
+    os::free_memory((char*)start, bytes, page_size());
+    os::numa_make_local((char*)start, bytes, _numa_lgrp_ids[node]);
+  }
+}
+
 container_t
 MutableBDASpace::container_for_addr(HeapWord * addr)
 {
@@ -632,95 +1044,127 @@ MutableBDASpace::add_to_pool(container_t c, uint id)
   grp->add_to_pool(c);
 }
 
+jint
+MutableBDASpace::save_tops_for_scavenge(CardTableModRefBS * ct)
+{
+  assert (SafepointSynchronize::is_at_safepoint(), "must be at a safepoint");
+  spaces()->at(0)->save_top_ptrs();
+  for (int i = 1; i < spaces()->length(); ++i) {
+    spaces()->at(i)->save_top_ptrs(ct);
+  }
+
+  // Segments are slot aligned, hence the chunks are card aligned.
+  const size_t chunk_words =
+    MAX2(BDAOldToYoungChunkSize, (uintx)1) * CardTableModRefBS::card_size_in_words;
+  jint n = 0;
+  for (int i = 0; i < spaces()->length(); ++i) {
+    n += spaces()->at(i)->scan_chunks(NULL, chunk_words);
+  }
+  if (n > _scan_chunks_capacity) {
+    if (_scan_chunks != NULL) {
+      FREE_C_HEAP_ARRAY(BDAScanChunk, _scan_chunks, mtGC);
+    }
+    _scan_chunks_capacity = MAX2(n, 2 * _scan_chunks_capacity);
+    _scan_chunks = NEW_C_HEAP_ARRAY(BDAScanChunk, _scan_chunks_capacity, mtGC);
+  }
+
+  jint i = 0;
+  for (int j = 0; j < spaces()->length(); ++j) {
+    i += spaces()->at(j)->scan_chunks(_scan_chunks + i, chunk_words);
+  }
+  assert (i == n, "every saved segment must be split in chunks");
+  _n_scan_chunks = n;
+  _next_scan_chunk = 0;
+  return n;
+}
+
 bool
 MutableBDASpace::adjust_layout(bool force)
 {
-  // We must force the layout to change and give space to the maximum occupying
-  // region
-  if(force) {
-    const float multiplier = 10.5;
-    const float diff_threshold = 0.7;
-    // Scan the regions to find the needy one
-    int i = -1;
+  assert (SafepointSynchronize::is_at_safepoint(), "must be at a safepoint");
+
+  // The most occupied bda-space, which grows even if its room is expected to last
+  int needy = -1;
+  if (force) {
     double max = 0.0;
-    for(int j = 0; j < spaces()->length(); ++j) {
-      MutableSpace* spc = spaces()->at(j)->space();
-      double occupancy_ratio =
-        (double)spc->used_in_words() / spc->capacity_in_words();
-      double free_ratio = 1 - occupancy_ratio;
-      if(occupancy_ratio - free_ratio > max) {
-        i = j;
-        max = occupancy_ratio - free_ratio;
+    for (int i = 1; i < spaces()->length(); ++i) {
+      MutableSpace * spc = spaces()->at(i)->space();
+      const double occupancy_ratio =
+        (double)spaces()->at(i)->reserved_words() / spc->capacity_in_words();
+      if (occupancy_ratio > max) {
+        needy = i;
+        max = occupancy_ratio;
       }
     }
-    // Do nothing if all were max occupied
-    if(i == -1)
-      return false;
-
-    MutableSpace* expand_spc = spaces()->at(i)->space();
-    double occ_ratio0 =
-      (double)expand_spc->used_in_words() / expand_spc->capacity_in_words();
-    // check if it's worth expanding or we just let a collection do the work
-    if (occ_ratio0 < 0.8)
-      return true;
+  }
 
-    double free_ratio0 = 1 - occ_ratio0;
-    const size_t free_space0_sz = expand_spc->free_in_words();
-    size_t expand_size = size_t(occ_ratio0 * multiplier * MinRegionSize);
-    // Scan the regions to find the first one that has enough space for the
-    // needy one.
-    int k = -1;
-    double free_ratio1 = 0.0;
-    size_t free_space1_sz = 0;
-    for(int j = i + 1; j < spaces()->length(); ++j) {
-      MutableSpace* spc = spaces()->at(j)->space();
-      free_ratio1 =
-        (double)spc->free_in_words() / spc->capacity_in_words();
-      free_space1_sz = spc->free_in_words();
-      if(free_ratio1 - free_ratio0 > diff_threshold) {
-        if((free_space1_sz / 2 > expand_size) &&
-           (free_space1_sz / 2 > MinRegionSize)) {
-          expand_size = free_space1_sz / 2;
-          k = j;
-          break;
-        }
-      } else {
-        if((free_space1_sz > expand_size) &&
-           (pointer_delta(spc->end(), spc->top() + expand_size) >= (j - i) * MinRegionSize)) {
-          k = j;
-          break;
-        }
-      }
+  // The general object space is never grown, since it ends with the old space
+  bool changed = false;
+  for (int i = 1; i < spaces()->length(); ++i) {
+    CGRPSpace * grp = spaces()->at(i);
+    const size_t expected = grp->expected_reserved_words();
+    const size_t room     = grp->unreserved_words();
+    size_t deficit = expected > room ? expected - room : 0;
+    if (deficit == 0 && i == needy) {
+      deficit = MAX2(expected, grp->segment_size());
     }
-    // Do nothing if the neighbouring regions have no space to share
-    if(k == -1)
-      return false;
-
-    MutableSpace* to_spc = spaces()->at(k)->space();
-    HeapWord* new_end =
-      (HeapWord*)round_to((intptr_t)(to_spc->top() + expand_size),
-                          MinRegionSizeBytes);
-    HeapWord* new_top = to_spc->top() == to_spc->bottom() ?
-      expand_spc->top() :
-      to_spc->top();
-
-    if(new_top > expand_spc->top()) {
-      // CollectedHeap::fill_with_object(expand_spc->top(),
-      //                                 pointer_delta(new_top, expand_spc->top()),
-      //                                 false);
+    if (deficit == 0) {
+      continue;
+    }
+
+    const size_t grown =
+      expand_region_to_neighbour(i, (size_t)align_size_up(deficit, MinRegionSize));
+    if (grown > 0) {
+      changed = true;
+      if (PrintGCDetails && Verbose) {
+        gclog_or_tty->print_cr("[BDA layout: space " INT32_FORMAT " grew " SIZE_FORMAT
+                               "K of the " SIZE_FORMAT "K expected]",
+                               grp->space_id(),
+                               grown * HeapWordSize / K, expected * HeapWordSize / K);
+      }
     }
+  }
+  return changed;
+}
+
+void
+MutableBDASpace::sample_reserved_words()
+{
+  for (int i = 0; i < spaces()->length(); ++i) {
+    spaces()->at(i)->sample_reserved_words();
+  }
+}
 
-    increase_space_set_top(expand_spc, pointer_delta(new_end, expand_spc->end()),
-                           new_top);
+void
+MutableBDASpace::reset_reserved_words()
+{
+  for (int i = 0; i < spaces()->length(); ++i) {
+    spaces()->at(i)->reset_reserved_words();
+  }
+}
 
-    size_t available_space_size = pointer_delta(to_spc->end(), expand_spc->end());
-    initialize_regions_evenly(i + 1, k, expand_spc->end(), to_spc->end(),
-                              available_space_size);
+void
+MutableBDASpace::fold_fragmentation_stats()
+{
+  for (int i = 0; i < spaces()->length(); ++i) {
+    spaces()->at(i)->fold_fragmentation_stats();
+  }
+}
 
-    return true;
-  } else {
-    // Not yet implemented
-    return false;
+void
+MutableBDASpace::recompute_fragmentation_stats()
+{
+  for (int i = 0; i < spaces()->length(); ++i) {
+    spaces()->at(i)->recompute_fragmentation_stats();
+  }
+}
+
+void
+MutableBDASpace::retire_spills()
+{
+  // The general object space is never given a spill
+  for (int i = 1; i < spaces()->length(); ++i) {
+    spaces()->at(i)->retire_spill();
   }
 }
 
@@ -747,46 +1191,75 @@ MutableBDASpace::compute_avg_freespace() {
   return MutableSpace::free_in_bytes() + (free_sz / (spaces()->length() - 1));
 }
 
-// TODO: FIXME: THIS NEEDS TO BE FIXED
 void
 MutableBDASpace::update_layout(MemRegion new_mr) {
-  // This is an expand
+  // The general object space ends the old space, so it takes all of a resize
+  MutableSpace* last_space = spaces()->at(0)->space();
   if(new_mr.end() > end()) {
-    size_t expand_size = pointer_delta(new_mr.end(), end());
-    // First we expand the last region (the other space), only then we update the layout
-    // This allow the following algorithm to check the borders without
-    // repeating operations.
-    MutableSpace* last_space = spaces()->at(0)->space();
+    // This is an expand
     last_space->initialize(MemRegion(last_space->bottom(), new_mr.end()),
                            SpaceDecorator::DontClear,
                            SpaceDecorator::DontMangle);
+    _shrink_wanted = 0;
+  } else if(new_mr.end() < end()) {
+    // This is a shrink, which never cuts more than shrinkable_bytes()
+    assert(new_mr.end() >= last_space->top() &&
+           pointer_delta(new_mr.end(), last_space->bottom()) >= MinRegionSize,
+           "the shrink cuts through the general object space");
+    shrink_space_end_noclear(last_space, pointer_delta(end(), new_mr.end()));
   }
-  // this is a shrink
-  else {
-    // size_t shrink_size = pointer_delta(end(), new_mr.end());
-    // // Naive implementation...
-    // int last = spaces()->length() - 1;
-    // if(spaces()->at(last)->space()->free_in_bytes() > shrink_size) {
-    //   shrink_space_end_noclear(spaces()->at(last)->space(), shrink_size);
-    // } else {
-    //   // raise the assertion fault below
-    // }
-  }
-
-  // Assert before leaving and set the whole space pointers
-  // TODO: Fix the order of the regions
-  // int j = 0;
-  // for(; j < spaces()->length(); ++j) {
-  //   assert(spaces()->at(j)->space()->capacity_in_words() >= MinRegionSize,
-  //          "segment is too short");
-  // }
-  // assert(spaces()->at(1)->space()->bottom() == new_mr.start() &&
-  //        spaces()->at(j - 1)->space()->end() == new_mr.end(), "just checking");
+
+  assert(spaces()->at(spaces()->length() > 1 ? 1 : 0)->space()->bottom() == new_mr.start() &&
+         last_space->end() == new_mr.end(), "the spaces must span the old space");
 
   set_bottom(new_mr.start());
   set_end(new_mr.end());
 }
 
+size_t
+MutableBDASpace::shrinkable_bytes() const
+{
+  const MutableSpace * spc = non_bda_space();
+  HeapWord * const limit = MAX2(spc->top(), spc->bottom() + MinRegionSize);
+  return spc->end() > limit ? pointer_delta(spc->end(), limit, 1) : 0;
+}
+
+void
+MutableBDASpace::prepare_shrink()
+{
+  assert (SafepointSynchronize::is_at_safepoint(), "must be at a safepoint");
+  const int last = lower_neighbour(0);
+  if (_shrink_wanted == 0 || last == -1) {
+    return;
+  }
+
+  // The last bda-space keeps the room it is expected to need until the next GC
+  const size_t sz = MIN2((size_t)align_size_up(_shrink_wanted, MinRegionSize),
+                         surplus_words(last));
+  _shrink_wanted = 0;
+  if (sz == 0) {
+    return;
+  }
+
+  MutableSpace * last_space  = spaces()->at(last)->space();
+  MutableSpace * other_space = non_bda_space();
+  HeapWord * const boundary  = last_space->end() - sz;
+  assert (other_space->bottom() == last_space->end(), "spaces are not neighbours");
+  spaces()->at(last)->release_pool(boundary, last_space->end());
+  shrink_space_end_noclear(last_space, sz);
+  // The range below the objects of the general object space holds none, so the
+  // summary slides the objects down over it.
+  other_space->initialize(MemRegion(boundary, other_space->end()),
+                          SpaceDecorator::DontClear,
+                          SpaceDecorator::DontMangle);
+  if (PrintGCDetails && Verbose) {
+    gclog_or_tty->print_cr("[BDA layout: space " INT32_FORMAT " gave " SIZE_FORMAT
+                           "K to the general object space for the old gen to shrink]",
+                           spaces()->at(last)->space_id(),
+                           sz * HeapWordSize / K);
+  }
+}
+
 void
 MutableBDASpace::increase_space_noclear(MutableSpace* spc, size_t sz)
 {
@@ -937,186 +1410,105 @@ MutableBDASpace::initialize_regions(size_t space_size,
   
 }
 
-void
-MutableBDASpace::expand_region_to_neighbour(int i, size_t expand_size)
+int
+MutableBDASpace::upper_neighbour(int i) const
 {
-  if(i == spaces()->length() - 1) {
-    // it was already pushed
-    return;
-  }
-
-  // This is the space that must grow
-  MutableSpace* space = spaces()->at(i)->space();
+  if (i == 0) return -1;
+  return i == spaces()->length() - 1 ? 0 : i + 1;
+}
 
-  // Sometimes this is called for no strong reason
-  // and we can avoid expanding to trigger an OldGC soon
-  if(pointer_delta(space->end(), space->top()) >= expand_size)
-    return;
+int
+MutableBDASpace::lower_neighbour(int i) const
+{
+  if (i == 0) return spaces()->length() > 1 ? spaces()->length() - 1 : -1;
+  return i - 1 > 0 ? i - 1 : -1;
+}
 
-  // This is to fill any leftovers of space. Don't zap!!!
-  size_t remainder = pointer_delta(space->end(), space->top());
-  if(remainder > CollectedHeap::min_fill_size()) {
-    CollectedHeap::fill_with_object(space->top(), remainder, false);
+size_t
+MutableBDASpace::surplus_words(int i) const
+{
+  const CGRPSpace * grp = spaces()->at(i);
+  // Keep a segment on top of the expected words, since the spaces that took
+  // nothing yet expect nothing
+  const size_t keep = grp->expected_reserved_words() + grp->segment_size();
+  const size_t room = grp->unreserved_words();
+  if (room <= keep) {
+    return 0;
   }
+  return MIN2((size_t)align_size_down(room - keep, MinRegionSize), passable_words(i));
+}
 
-  // We grow into the neighbouring space, if possible...
-  MutableSpace* neighbour_space = spaces()->at(i+1)->space();
-  HeapWord* neighbour_top = neighbour_space->top();
-  HeapWord* neighbour_end = neighbour_space->end();
-  HeapWord* neighbour_bottom = neighbour_space->bottom();
-
-  // ... always leaving a MinRegionSize to cope with the compactor later on
-  // see PSParallelCompact::summarize_spaces_quick()
-  if(pointer_delta(neighbour_end, neighbour_top) >= expand_size + MinRegionSize) {
-    grow_through_neighbour(space, neighbour_space, expand_size);
-    return;
-  } else if(pointer_delta(neighbour_end, neighbour_top) >= expand_size) {
-    // neighbour has enough space, but it should not be compacted for less than
-    // then MinRegionSize value between its bottom and end values.
-    // Therefore, we push expanding region end forward and then fit the
-    // neighbours. But first we try to fit the neighbour in its neighbour,
-    // before increasing the space or there'd be problems in reversing the op
-    // in case the function return false.
-    if(try_fitting_on_neighbour(i + 1)) {
-      increase_space_set_top(space, pointer_delta(neighbour_end, neighbour_bottom),
-                             neighbour_top);
-    } else {
-      // Nothing to do then trigger a collection
-      return;
-    }
-  } else {
-    // Neighbour does not have enough space, thus we grow into its neighbours.
-    // The neighbour chosen must have enough space for MinRegionSize on each
-    // region in between and the expand_size.
-    // This j value is sure to be in bounds since the above is always true
-    // for the last-1 region
-    int j = i + 2;
-    bool found = false;
-    for(; j < spaces()->length(); ++j) {
-      if(spaces()->at(j)->space()->free_in_words() >= expand_size + (j - i) * MinRegionSize)
-        found = true;
-      break;
-    }
-
-    // There's no space so trigger a collection
-    if(!found)
-      return;
-
-    // There is space, so expand the space and shrink all neighbours evenly
-    MutableSpace* to_space = spaces()->at(j)->space();
-    HeapWord* new_end = (HeapWord*)round_to((intptr_t)(to_space->top() + expand_size),
-                                            MinRegionSizeBytes);
-    increase_space_set_top(space, pointer_delta(new_end, space->end()), to_space->top());
-
-
-    size_t available_space_size = pointer_delta(to_space->end(), space->end());
-    initialize_regions_evenly(j, i + 1, space->end(), to_space->end(),
-                              available_space_size);
+size_t
+MutableBDASpace::passable_words(int i) const
+{
+  const MutableSpace * spc = spaces()->at(i)->space();
+  if (spc->capacity_in_words() <= MinRegionSize) {
+    return 0;
   }
+  return (size_t)align_size_down(MIN2(spc->free_in_words(),
+                                      spc->capacity_in_words() - MinRegionSize),
+                                 MinRegionSize);
 }
 
-bool
-MutableBDASpace::try_fitting_on_neighbour(int moved_id)
-{
-  // First check the regions that may contain enough space for both
-  int to_id = -1;
-  for(int j = moved_id + 1; j < spaces()->length(); ++j)  {
-    if(spaces()->at(j)->space()->capacity_in_words() >= 2 * MinRegionSize) {
-      to_id = j;
-      break;
+size_t
+MutableBDASpace::expand_region_to_neighbour(int i, size_t expand_size)
+{
+  assert (i > 0, "the general object space is not grown");
+  assert ((expand_size & MinRegionSizeOffsetMask) == 0, "must grow by whole slots");
+
+  // The boundaries only move over free words. The segments of a space cannot sit
+  // in the range of another one, since the summary of a full GC compacts the
+  // segments of each space within its range. Thus a space only grows at its end
+  // if its upper neighbour is empty, and otherwise grows at its bottom with the free
+  // end of its lower neighbour, which the neighbours further below may replenish.
+  size_t grown = 0;
+  MutableSpace * spc = spaces()->at(i)->space();
+
+  const int upper = upper_neighbour(i);
+  if (upper != -1) {
+    MutableSpace * upper_spc = spaces()->at(upper)->space();
+    if (upper_spc->top() == upper_spc->bottom()) {
+      const size_t sz = MIN2(expand_size, surplus_words(upper));
+      if (sz > 0) {
+        spaces()->at(upper)->release_pool(upper_spc->bottom(), upper_spc->bottom() + sz);
+        upper_spc->initialize(MemRegion(upper_spc->bottom() + sz, upper_spc->end()),
+                              SpaceDecorator::Clear,
+                              SpaceDecorator::DontMangle);
+        increase_space_noclear(spc, sz);
+        grown += sz;
+      }
     }
   }
-  if(to_id == -1)
-    return false;
-
-  // Now we can try fit the moved space on the to-space, taking into account
-  // the old occupations that they had.
-  MutableSpace* moved_space = spaces()->at(moved_id)->space();
-  MutableSpace* to_space = spaces()->at(to_id)->space();
-
-  const double moved_occupancy_ratio =
-    (double)moved_space->used_in_words() / moved_space->capacity_in_words();
-  // TODO: Do we account to the expasion done earlier, if to_space is the last???
-  const double to_occupancy_ratio =
-    (double)to_space->used_in_words() / to_space->capacity_in_words();
-  const double moved_free_ratio = 1 - moved_occupancy_ratio;
-  const double to_free_ratio = 1 - to_occupancy_ratio;
-
-  const size_t to_space_capacity = to_space->capacity_in_words();
-
-  // the spaces that each region will end up occupying
-  size_t new_moved_space_sz = 0;
-  size_t new_to_space_sz = 0;
-
-  // This means that at least it fits on the neighbour with its old occupancy
-  // and that it can use a portion of the neighbour's space.
-  if (moved_occupancy_ratio + to_occupancy_ratio <= 1) {
-    if (moved_occupancy_ratio >= to_occupancy_ratio) {
-      new_moved_space_sz = MAX2((size_t)(moved_occupancy_ratio * to_space_capacity),
-                                MinRegionSize);
-    } else {
-      new_moved_space_sz = MAX2((size_t)(to_free_ratio * to_space_capacity),
-                                MinRegionSize);
 
+  if (grown < expand_size) {
+    ResourceMark rm;
+    int *    chain = NEW_RESOURCE_ARRAY(int, spaces()->length());
+    size_t * given = NEW_RESOURCE_ARRAY(size_t, spaces()->length());
+    int      depth = 0;
+
+    // Walk down while the spaces below are asked for words. Each one gives from its
+    // surplus and asks the ones below for the rest, as much as its free end can pass.
+    size_t wanted = expand_size - grown;
+    for (int j = lower_neighbour(i); j != -1 && wanted > 0; j = lower_neighbour(j)) {
+      const size_t sz = MIN2(wanted, surplus_words(j));
+      chain[depth] = j;
+      given[depth] = sz;
+      depth++;
+      wanted = MIN2(wanted - sz, passable_words(j) - sz);
     }
-  } else {
-    //const double diff = moved_free_ratio - to_free_ration;
-    // means that one of the regions is at least > 0.5 occupied
 
-    // ..and that is the to-space
-    if(moved_free_ratio >= to_free_ratio) {
-      new_moved_space_sz = MAX2((size_t)(to_free_ratio * to_space_capacity),
-                                MinRegionSize);
-    } else {
-      new_moved_space_sz = MAX2((size_t)(moved_occupancy_ratio * to_space_capacity),
-                                MinRegionSize);
+    // Then move the boundaries up, from the lowest space
+    size_t passed = 0;
+    for (int d = depth - 1; d >= 0; --d) {
+      passed += given[d];
+      if (passed > 0) {
+        shrink_and_adapt(chain[d], passed);
+      }
     }
+    grown += passed;
   }
 
-  HeapWord* aligned_limit =
-    (HeapWord*)round_to((intptr_t)(to_space->bottom() + new_moved_space_sz),
-                        MinRegionSizeBytes);
-  new_to_space_sz = pointer_delta(to_space->end(), aligned_limit);
-  if(new_to_space_sz < MinRegionSize)
-    return false;
-
-  // just checking
-  assert(new_moved_space_sz >= MinRegionSize &&
-         new_to_space_sz >= MinRegionSize, "size too short");
-
-  // This is already aligned
-  move_space_resize(moved_space, to_space->bottom(),
-                    pointer_delta(aligned_limit, to_space->bottom()));
-  if (moved_space->contains(to_space->top())) {
-    moved_space->set_top(to_space->top());
-    shrink_space_clear(to_space, moved_space->capacity_in_words());
-  } else {
-    moved_space->set_top(moved_space->end());
-    shrink_space_noclear(to_space, moved_space->capacity_in_words());
-  }
-
-  assert(to_space->capacity_in_words() == new_to_space_sz, "checking sizing");
-  return true;
-}
-
-void
-MutableBDASpace::grow_through_neighbour(MutableSpace* growee,
-                                        MutableSpace* eaten,
-                                        size_t expand_size)
-{
-  growee->initialize(MemRegion(growee->bottom(),
-                               (HeapWord*)round_to((intptr_t)(eaten->top() + expand_size),
-                                                   MinRegionSizeBytes)),
-                     SpaceDecorator::DontClear,
-                     SpaceDecorator::DontMangle);
-  growee->set_top(eaten->top());
-
-  // Mangle to prevent following possible objects and to raise errors
-  // fast in case something is wrong.
-  eaten->initialize(MemRegion(growee->end(),
-                              eaten->end()),
-                    SpaceDecorator::Clear,
-                    SpaceDecorator::Mangle);
+  return grown;
 }
 
 void
@@ -1131,37 +1523,30 @@ MutableBDASpace::merge_regions(int growee, int eaten) {
 }
 
 void
-MutableBDASpace::shrink_and_adapt(int grp) {
-  MutableSpace* grp_space = spaces()->at(grp)->space();
-  grp_space->initialize(MemRegion(grp_space->end(), (size_t)0),
-                        SpaceDecorator::Clear,
-                        SpaceDecorator::DontMangle);
-  // int max_grp_id = 0;
-  // size_t max = 0;
-  // for(int i = 0; i < spaces()->length(); ++i) {
-  //   if(MAX2(free_in_words(i), max) != max)
-  //     max_grp_id = i;
-  // }
-
-  // MutableSpace* max_grp_space = spaces()->at(max_grp_id)->space();
-  // MutableSpace* grp_space = spaces()->at(grp)->space();
-
-  // size_t sz_to_set = 0;
-  // if((sz_to_set = max_grp_space->free_in_words() / 2) > OldPLABSize) {
-  //   HeapWord* aligned_top = (HeapWord*)round_to((intptr_t)max_grp_space->top() + sz_to_set, page_size());
-  //   // should already be aligned
-  //   HeapWord* aligned_end = max_grp_space->end();
-  //   max_grp_space->initialize(MemRegion(max_grp_space->bottom(), aligned_top),
-  //                             SpaceDecorator::DontClear,
-  //                             SpaceDecorator::DontMangle);
-  //   grp_space->initialize(MemRegion(aligned_top, aligned_end),
-  //                         SpaceDecorator::Clear,
-  //                         SpaceDecorator::DontMangle);
-  // } else {
-  //   grp_space->initialize(MemRegion(max_grp_space->end(), (size_t)0),
-  //                         SpaceDecorator::Clear,
-  //                         SpaceDecorator::Mangle);
-  // }
+MutableBDASpace::shrink_and_adapt(int grp, size_t sz) {
+  const int upper = upper_neighbour(grp);
+  assert (upper > 0, "the general object space takes no spill");
+  MutableSpace * grp_space = spaces()->at(grp)->space();
+  CGRPSpace *    upper_grp = spaces()->at(upper);
+  MutableSpace * upper_space = upper_grp->space();
+  HeapWord * const boundary = grp_space->end() - sz;
+  assert (upper_space->bottom() == grp_space->end(), "spaces are not neighbours");
+  assert (boundary >= grp_space->top(), "only the free end is given");
+  assert (grp_space->capacity_in_words() - sz >= MinRegionSize, "space is too short");
+
+  spaces()->at(grp)->release_pool(boundary, grp_space->end());
+  shrink_space_end_noclear(grp_space, sz);
+  if (upper_space->top() == upper_space->bottom()) {
+    // An empty space just starts lower
+    upper_space->initialize(MemRegion(boundary, upper_space->end()),
+                            SpaceDecorator::Clear,
+                            SpaceDecorator::DontMangle);
+  } else {
+    upper_grp->add_spill(boundary);
+    upper_space->initialize(MemRegion(boundary, upper_space->end()),
+                            SpaceDecorator::DontClear,
+                            SpaceDecorator::DontMangle);
+  }
 }
 
 /* --------------------------------------------- */
@@ -1320,45 +1705,25 @@ MutableBDASpace::free_in_bytes(int grp) const {
 size_t
 MutableBDASpace::capacity_in_words(Thread *thr) const {
   guarantee(thr != NULL, "No thread");
-  BDARegion* ctype = thr->alloc_region();
-  int i = spaces()->find(&ctype, CGRPSpace::equals);
-  if( i == -1 )
-    i = 0;
-
-  return spaces()->at(i)->space()->capacity_in_words();
+  return grp_for(thr->alloc_region())->space()->capacity_in_words();
 }
 
 size_t
 MutableBDASpace::tlab_capacity(Thread *thr) const {
   guarantee(thr != NULL, "No thread");
-  BDARegion* ctype = thr->alloc_region();
-  int i = spaces()->find(&ctype, CGRPSpace::equals);
-  if( i == -1 )
-    i = 0;
-
-  return spaces()->at(i)->space()->capacity_in_bytes();
+  return grp_for(thr->alloc_region())->space()->capacity_in_bytes();
 }
 
 size_t
 MutableBDASpace::tlab_used(Thread *thr) const {
   guarantee(thr != NULL, "No thread");
-  BDARegion* ctype = thr->alloc_region();
-  int i = spaces()->find(&ctype, CGRPSpace::equals);
-  if( i == -1 )
-    i = 0;
-
-  return spaces()->at(i)->space()->used_in_bytes();
+  return grp_for(thr->alloc_region())->space()->used_in_bytes();
 }
 
 size_t
 MutableBDASpace::unsafe_max_tlab_alloc(Thread *thr) const {
   guarantee(thr != NULL, "No thread");
-  BDARegion* ctype = thr->alloc_region();
-  int i = spaces()->find(&ctype, CGRPSpace::equals);
-  if( i == -1 )
-    i = 0;
-
-  return spaces()->at(i)->space()->free_in_bytes();
+  return grp_for(thr->alloc_region())->space()->free_in_bytes();
 }
 
 // // // // // // // // // //
@@ -1394,17 +1759,20 @@ HeapWord* MutableBDASpace::cas_allocate(size_t size) {
 }
 
 container_t
-MutableBDASpace::allocate_container(size_t size, BDARegion* r)
+MutableBDASpace::allocate_container(size_t size, BDARegion* r, uint worker_id, int node)
 {
-  int i = spaces()->find(r, CGRPSpace::equals);
-  assert(i > 0, "Containers can only be allocated in bda spaces already initialized");
-  CGRPSpace * cs = spaces()->at(i);
-  container_t new_ctr = cs->push_container(size);
+  assert(BDARegion::space_id(r) > 0 && BDARegion::space_id(r) < spaces()->length(),
+         "Containers can only be allocated in bda spaces already initialized");
+  CGRPSpace * cs = grp_for(r);
+  container_t new_ctr = cs->push_container(size, worker_id, 0, node);
 
   // If it failed to allocate a container in the specified space
   // then allocate a container in the "other" space.
   if (new_ctr == NULL) {
-    new_ctr = spaces()->at(0)->push_container(size);
+    new_ctr = spaces()->at(0)->push_container(size, worker_id, 0, node);
+  }
+  if (new_ctr != NULL) {
+    spaces()->at((int)new_ctr->_space_id)->frag_deltas(worker_id)->add_chain();
   }
 
   return new_ctr;
@@ -1413,7 +1781,7 @@ MutableBDASpace::allocate_container(size_t size, BDARegion* r)
 //
 // 
 HeapWord*
-MutableBDASpace::allocate_element(size_t size, container_t& container)
+MutableBDASpace::allocate_element(size_t size, container_t& container, uint worker_id)
 {
   HeapWord * old_top;
   container_t segment = container;
@@ -1424,6 +1792,7 @@ MutableBDASpace::allocate_element(size_t size, container_t& container)
     while ((old_top = segment->_top) + size < segment->_end) {
       HeapWord * new_top = old_top + size;
       if ((HeapWord*)Atomic::cmpxchg_ptr(new_top, &(segment->_top), old_top) == old_top) {
+        note_segment_top(segment, old_top, new_top, worker_id);
         allocate_block (old_top);
         return old_top;
       }
@@ -1434,27 +1803,28 @@ MutableBDASpace::allocate_element(size_t size, container_t& container)
   CGRPSpace * grp = spaces()->at((int)container->_space_id);
   assert (grp != NULL, "container must have been allocated in one of the groups");
   assert (container != NULL, "container cannot be null during allocation");
-  old_top = grp->allocate_new_segment(size, container); // reuse the variable
+  old_top = grp->allocate_new_segment(size, container, worker_id); // reuse the variable
 
   // Force allocate in the general object space if it wasn't possible on the bda-space
   if (old_top == NULL) {
-    old_top = spaces()->at(0)->allocate_new_segment(size, container);
+    old_top = spaces()->at(0)->allocate_new_segment(size, container, worker_id);
   }
   
   return old_top;
 }
 
 HeapWord *
-MutableBDASpace::allocate_plab (container_t& container)
+MutableBDASpace::allocate_plab (container_t& container, size_t size, uint worker_id)
 {
   HeapWord *  old_top;
   container_t segment = container;
   // Jump to the last segment first and update the arg in the meanwhile.
   do {
     // and try to allocate the plab
-    while ((old_top = segment->_top) + BDAOldPLABSize < segment->_end) {
-      HeapWord * new_top = old_top + BDAOldPLABSize;
+    while ((old_top = segment->_top) + size < segment->_end) {
+      HeapWord * new_top = old_top + size;
       if ((HeapWord*)Atomic::cmpxchg_ptr(new_top, &(segment->_top), old_top) == old_top) {
+        note_segment_top(segment, old_top, new_top, worker_id);
         allocate_block (old_top);
         return old_top;
       }
@@ -1464,11 +1834,11 @@ MutableBDASpace::allocate_plab (container_t& container)
   // Which space was this container allocated?
   CGRPSpace * grp = spaces()->at((int)container->_space_id);
   assert (grp != NULL, "The container must have been allocated in one of the groups");
-  old_top = grp->allocate_new_segment(BDAOldPLABSize, container); // reuse the variable
+  old_top = grp->allocate_new_segment(size, container, worker_id); // reuse the variable
 
   // Force allocate in the general object space if it wasn't possible on the bda-space
   if (old_top == NULL) {
-    old_top = spaces()->at(0)->allocate_new_segment(BDAOldPLABSize, container);
+    old_top = spaces()->at(0)->allocate_new_segment(size, container, worker_id);
   }
 
   // The container now belongs to this thread only (the one executing this code).
@@ -1476,6 +1846,23 @@ MutableBDASpace::allocate_plab (container_t& container)
   
   return old_top;
 }
+
+void
+MutableBDASpace::retract_segment_caches()
+{
+  // The general object space does not cache segments
+  for (int i = 1; i < spaces()->length(); ++i) {
+    spaces()->at(i)->retract_segment_caches();
+  }
+}
+
+void
+MutableBDASpace::retire_segment_caches()
+{
+  for (int i = 1; i < spaces()->length(); ++i) {
+    spaces()->at(i)->retire_segment_caches();
+  }
+}
 //////////////// END OF ALLOCATION FUNCTIONS ////////////////
 
 void
@@ -1490,14 +1877,26 @@ MutableBDASpace::clear_delete_containers_in_space(uint space_id)
   CGRPSpace * grp = spaces()->at(space_id);
   grp->clear_delete_containers();
 
-  // Unset all bits in the segment_bitmap
+  // Unset all bits in the segment bitmaps. The slots partially covered by the space
+  // have no segment marked, since the marked segments lie within the space.
   HeapWord * const bottom = grp->space()->bottom();
   HeapWord * const top    = grp->space()->top();
-  _segment_bitmap.clear_range(_segment_bitmap.addr_to_bit(bottom),
-                              _segment_bitmap.addr_to_bit(top));
+  const size_t beg_slot = slot_for(bottom);
+  const size_t end_slot = slot_for(top + MinRegionSize - 1);
+  _segment_beg_slots.clear_range(beg_slot, end_slot);
+  _segment_end_slots.clear_range(beg_slot, end_slot);
+}
+
+void
+MutableBDASpace::resize_segments()
+{
+  if (!BDAAdaptiveSegmentSize) return;
+  // The general object space keeps its segments
+  for (int i = 1; i < spaces()->length(); ++i) {
+    spaces()->at(i)->resize_segments();
+  }
 }
 
-#ifdef ASSERT
 void
 MutableBDASpace::reset_grp_stats()
 {
@@ -1505,7 +1904,20 @@ MutableBDASpace::reset_grp_stats()
     spaces()->at(i)->reset_stats();
   }
 }
-#endif
+
+void
+MutableBDASpace::initialize_performance_counters()
+{
+  _counters = new BDACounters(this);
+}
+
+void
+MutableBDASpace::update_counters()
+{
+  if (UsePerfData && _counters != NULL) {
+    _counters->update_all();
+  }
+}
 
 void MutableBDASpace::clear(bool mangle_space)
 {
@@ -1736,10 +2148,6 @@ MutableBDASpace::print_spaces_fragmentation_stats() const
     // asserts
     assert ( grp->container_count() > 0, "Shouldn't reach here without containers" );
 
-    // Compute the average segment fragmentation and variance.
-    // Both the average and the variance are calculated using the
-    // incremental method in a similar fashion to what Donald Knuth presents of
-    // B. P. Welford's method.
     grp->print_container_fragmentation_stats();
   }
 }
@@ -1816,6 +2224,24 @@ MutableBDASpace::verify_segments_in_othergen() const
   }
 }
 #endif
+void
+MutableBDASpace::select_spaces_to_defragment()
+{
+  for (int i = 1; i < spaces()->length(); ++i) {
+    CGRPSpace * grp = spaces()->at(i);
+    // A space with a single segment has nothing to merge
+    bool defragment = false;
+    if (BDADefragmentAtFullGC && grp->container_count() > 1) {
+      defragment = grp->container_fragmentation(NULL) * 100 >= (double)BDADefragmentThreshold;
+    }
+    grp->set_defragment(defragment);
+    if (defragment && BDAllocationVerboseLevel > 0) {
+      gclog_or_tty->print_cr("[BDA space " INT32_FORMAT ": defragmenting " INT32_FORMAT " segments]",
+                             i, grp->container_count());
+    }
+  }
+}
+
 /**
  * STATISTICS FUNCTIONS
  */
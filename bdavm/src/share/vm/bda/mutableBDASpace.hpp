@@ -2,7 +2,9 @@
 #define SHARE_VM_BDA_MUTABLEBDASPACE_HPP
 
 # include "bda/bdaGlobals.hpp"
+# include "bda/bdaStats.hpp"
 # include "bda/gen_queue.hpp"
+# include "gc_implementation/shared/gcUtil.hpp"
 # include "gc_implementation/shared/mutableSpace.hpp"
 # include "gc_implementation/parallelScavenge/objectStartArray.hpp"
 # include "gc_implementation/parallelScavenge/parMarkBitMap.hpp"
@@ -16,6 +18,31 @@ class Thread;
 class CollectedHeap;
 class SpaceDecorator;
 class ObjectStartArray;
+class CardTableModRefBS;
+class BDACounters;
+class BDAPhaseTimes;
+
+//
+// BDAScanChunk is a card aligned range of a segment, below the top saved at the start
+// of a scavenge, that a gc thread scans for old-to-young refs (see OldToYoungBDARootsTask).
+//
+class BDAScanChunk VALUE_OBJ_CLASS_SPEC {
+
+ private:
+  container_t _segment;
+  HeapWord *  _beg;
+  HeapWord *  _end;
+
+ public:
+
+  BDAScanChunk () : _segment(NULL), _beg(NULL), _end(NULL) { }
+  BDAScanChunk (container_t c, HeapWord * beg, HeapWord * end) :
+    _segment(c), _beg(beg), _end(end) { }
+
+  container_t segment () const { return _segment; }
+  HeapWord *  beg     () const { return _beg; }
+  HeapWord *  end     () const { return _end; }
+};
 
 //
 // The MutableBDASpace class is a general object that encapsulates multiple
@@ -42,6 +69,10 @@ class MutableBDASpace : public MutableSpace
 
   static size_t       _filler_header_size;
 
+  // The node of a segment allocated on behalf of no thread in particular, which is
+  // placed on the node of the gc thread allocating it (see BDANUMAPlacement).
+  enum { any_numa_node = -1 };
+
   // This class wraps the addressable space of the MutableBDASpace
   // for a particular collection type, or none at all.
   class CGRPSpace : public CHeapObj<mtGC>
@@ -49,6 +80,32 @@ class MutableBDASpace : public MutableSpace
     friend class MutableBDASpace;
     
     enum { CONTAINER_IN_POOL_MASK = 1 };
+
+    // A run of regular segments reserved at once by a gc thread, from which the thread
+    // takes new segments without synchronizing with the others. Padded to a cache line
+    // since the caches of all gc threads are laid out in the same array.
+    class SegmentCache VALUE_OBJ_CLASS_SPEC {
+      HeapWord * _cur;
+      HeapWord * _end;
+      char       _pad[DEFAULT_CACHE_LINE_SIZE - 2 * sizeof(HeapWord*)];
+
+     public:
+      SegmentCache() : _cur(NULL), _end(NULL) { }
+
+      HeapWord * cur() const     { return _cur; }
+      HeapWord * end() const     { return _end; }
+      bool       is_empty() const { return _cur == _end; }
+
+      void set_run(HeapWord * cur, HeapWord * end) { _cur = cur; _end = end; }
+      void reset()                                { _cur = _end = NULL; }
+
+      HeapWord * claim(size_t sz) {
+        if (pointer_delta(_end, _cur) < sz) return NULL;
+        HeapWord * ptr = _cur;
+        _cur += sz;
+        return ptr;
+      }
+    };
     
     MutableSpace *                 _space;
     BDARegion *                    _type;
@@ -56,42 +113,74 @@ class MutableBDASpace : public MutableSpace
     // If their contents can be merged onto another container of the same family, then
     // they shall but only at OldGC, i.e., only when the old space is actually scanned.
     GenQueue<container_t, mtGC> * _containers;
-    // A pool of containers already allocated and ready
-    // to be assigned to a space, i.e., it works as a cache of free containers in order
-    // to avoid free/malloc of new ones. It is implemented as a queue that wether fills
-    // or empties, during the final OldGC phase and during Young GC, respectively.
-    GenQueue<container_t, mtGC> * _pool;
-    // Pool of large containers already allocated and ready to be assign to a space.
-    GenQueue<container_t, mtGC> * _large_pool;
+    // Number of free segments left installed in the RegionData by the last OldGC, i.e.,
+    // whose descriptors are masked as in the pool. Their descriptors stay in the side
+    // table of the manager, so the pool needs no list of them. It fills during the final
+    // OldGC phase and empties during Young GC.
+    volatile jint                  _pooled_segments;
     // GC support
     container_t          _last_segment;
     // A pointer to the parent
     MutableBDASpace *              _manager;
+    // One segment cache per gc thread, plus one for the VM thread, indexed by the
+    // id of their promotion managers. With BDANUMAPlacement each thread has one
+    // cache per node, whose runs are biased to it, at worker_id * numa_nodes() + node.
+    SegmentCache *                 _caches;
+    uint                           _n_caches;
+
+    // Size of the regular segments of this space. It adapts between GCs to the growth
+    // of the containers (see resize_segments()), starting at segment_sz.
+    size_t                         _segment_sz;
+    // Number of consecutive GCs in which no container of the space outgrew its segment
+    int                            _quiet_gcs;
 
     // Stats fields:
     //  Number of segments allocated or returned from the pool in the last gc
-    int _segments_since_last_gc;
+    volatile jint _segments_since_last_gc;
+    //  How many of those extended an existing container
+    volatile jint _extensions_since_last_gc;
+    // Set before a full GC when the containers of the space are to be rewritten
+    // into contiguous runs (see BDADefragmentAtFullGC)
+    bool          _defragment;
+    // Words taken by the segments of the space at the end of the last GC, and the
+    // average of the words taken between two GCs, padded with their deviation. They
+    // tell how much room the space needs until the next GC (see adjust_layout()).
+    size_t                   _reserved_at_last_gc;
+    AdaptivePaddedAverage *  _avg_reserved;
+    // The fill ratio and chain length stats of the segments, as of the last fold, and
+    // the deltas recorded by each gc thread since, indexed as the promotion managers.
+    // Only the owner thread writes its deltas, so they need no synchronization.
+    BDAFragmentationStats    _frag_stats;
+    BDAFragmentationStats *  _frag_deltas;
+    // The range below the segments of the space given to it by its lower neighbour
+    // (see shrink_and_adapt()). When the top of the space reaches its end, the gc
+    // threads claim new segments from the spill with a CAS.
+    HeapWord * volatile      _spill_top;
+    HeapWord *               _spill_end;
     
 
     // Helper function to calculate the power of base over exponent using bit-wise
     // operations. It is inlined for such.
     static inline int    power_function(int base, int exp);
-    // Allocates a container in the space.
-    // It allocates both containers with parent object and segments with children objects.
-    container_t allocate_container();
+    // Gets the descriptor of a container starting at start from the side table.
+    // It serves both containers with parent object and segments with children objects.
+    container_t allocate_container(HeapWord * start);
     // Sets up the container with its limits and adds it to the RegionData that spans
     // the container addressable space.
     inline void setup_container(container_t& container, MemRegion mr, size_t obj_sz);
     // Does both of the above
     container_t allocate_and_setup_container(HeapWord * start, size_t reserved_sz, size_t obj_sz);
-    // Also calculates a container segment size, but only based on the size_t
-    container_t allocate_large_container(size_t size);
-    // Free a container's memory
-    void free_container (container_t container);
-    // Tries to reuse segments from the normal sized segments pool in order to allocate a large
-    // segment. This is only called when there are no large segments in the large_pool or they
-    // are not enough.
-    bool        reuse_from_pool (container_t& c, size_t size);
+    // Sets up the container for a segment already reserved at ptr, taking the
+    // descriptors of the slots it spans out of the pool.
+    container_t install_segment(HeapWord * ptr, size_t reserved_sz, size_t size);
+    // Takes a regular segment from the cache of the gc thread for node, refilling it
+    // if needed.
+    HeapWord *  claim_segment(uint worker_id, int node);
+    // Takes sz words from the spill, or returns NULL if there are not as many left.
+    HeapWord *  claim_spill(size_t sz);
+    // Makes the spill start at beg, below the bottom of the space. Called before the
+    // bottom is moved down to beg.
+    void        add_spill(HeapWord * beg);
     // Masks containers by ORing the CONTAINER_IN_POOL_MASK on the _start field of the struct
     // Any subsequent use must unmask the container because an ORed _start is invalid since
     // containers/segments are aligned byte aligned.
@@ -107,58 +196,86 @@ class MutableBDASpace : public MutableSpace
     static int delegation_level;
     static int default_collection_size;
     static int node_fields;
-    // This value is kept since it is the same for every regular segment.
+    // The initial size of the regular segments, computed from the launch parameters.
+    // The spaces are aligned to it.
     static size_t segment_sz;
 
     CGRPSpace(size_t alignment, BDARegion * region, MutableBDASpace * manager) :
       _type(region), _manager(manager) {
       _space = new MutableSpace(alignment);
       _containers = GenQueue<container_t, mtGC>::create();
-      _pool = GenQueue<container_t, mtGC>::create();
-      _large_pool = GenQueue<container_t, mtGC>::create();
+      _pooled_segments = 0;
+      _segment_sz = segment_sz;
+      _quiet_gcs = 0;
       _segments_since_last_gc = 0;
-    }
-    ~CGRPSpace() {
-      delete _space;
-      for (GenQueueIterator<container_t, mtGC> iterator = _containers->iterator();
-           *iterator != NULL;
-           ++iterator) {
-        container_t c = *iterator;
-        FreeHeap((void*)c, mtGC);
-      }
-      for (GenQueueIterator<container_t, mtGC> iterator = _pool->iterator();
-           *iterator != NULL;
-           ++iterator) {
-        container_t c = *iterator;
-        FreeHeap((void*)c, mtGC);
+      _extensions_since_last_gc = 0;
+      _defragment = false;
+      _reserved_at_last_gc = 0;
+      _avg_reserved = new AdaptivePaddedAverage(AdaptiveSizePolicyWeight, PromotedPadding);
+      _frag_deltas = NEW_C_HEAP_ARRAY(BDAFragmentationStats, ParallelGCThreads + 1, mtGC);
+      for (uint i = 0; i < ParallelGCThreads + 1; i++) {
+        ::new (&_frag_deltas[i]) BDAFragmentationStats();
       }
-      for (GenQueueIterator<container_t, mtGC> iterator = _large_pool->iterator();
-           *iterator != NULL;
-           ++iterator) {
-        container_t c = *iterator;
-        FreeHeap((void*)c, mtGC);
+      _spill_top = NULL;
+      _spill_end = NULL;
+      _n_caches = (ParallelGCThreads + 1) * manager->numa_nodes();
+      _caches = NEW_C_HEAP_ARRAY(SegmentCache, _n_caches, mtGC);
+      for (uint i = 0; i < _n_caches; i++) {
+        ::new (&_caches[i]) SegmentCache();
       }
     }
-
-    static bool equals(void* container_type, CGRPSpace* s) {
-      return (BDARegion*)container_type == s->container_type();
+    ~CGRPSpace() {
+      delete _space;
+      delete _avg_reserved;
+      FREE_C_HEAP_ARRAY(SegmentCache, _caches, mtGC);
+      FREE_C_HEAP_ARRAY(BDAFragmentationStats, _frag_deltas, mtGC);
+      // The descriptors belong to the side table of the manager
     }
 
     BDARegion *      container_type()  const { return _type; }
+    // Its index in the spaces() of the manager
+    int              space_id()        const { return _type->space_id(); }
     MutableSpace *   space()           const { return _space; }
     int              container_count() const { return _containers->n_elements(); }
+    int              pooled_count()    const { return _pooled_segments; }
+    jint             segments_since_last_gc()   const { return _segments_since_last_gc; }
+    jint             extensions_since_last_gc() const { return _extensions_since_last_gc; }
+    size_t           segment_size()    const { return _segment_sz; }
+    bool             should_defragment() const { return _defragment; }
+    void             set_defragment(bool v)    { _defragment = v; }
     
-    // This is called for new collections, i.e., that need a parent container
-    inline container_t   push_container(size_t size);
+    // This is called for new collections, i.e., that need a parent container. The
+    // segment reserved is at least min_reserved_sz large, and is placed on node.
+    container_t          push_container(size_t size, uint worker_id, size_t min_reserved_sz = 0,
+                                        int node = any_numa_node);
+    // This is called at full GC for the region of the old space moved into this space,
+    // with size live words. The new container spans a single MinRegionSize slot.
+    container_t          push_region_container(size_t size);
     // This is called for already existing collections when they need a new segment
-    inline HeapWord *    allocate_new_segment(size_t size, container_t& c);
+    HeapWord *           allocate_new_segment(size_t size, container_t& c, uint worker_id);
+    // Gives the runs cached by the gc threads that end at the top back to the space.
+    // The others are kept for the next scavenge. Called at the end of a scavenge.
+    void                 retract_segment_caches();
+    // Gives every run cached by the gc threads back, turning the ones below the top
+    // into empty containers. Called before a full GC, whose summary needs every slot
+    // below the top in a segment, and when the segment size changes.
+    void                 retire_segment_caches();
+    // Turns the unclaimed part of the spill into empty containers. Called before a
+    // full GC, as retire_segment_caches().
+    void                 retire_spill();
+    // Hands the unclaimed part of the spill to an empty cache, if it spans whole
+    // segments. Returns false if it could not.
+    bool                 cache_spill();
     // This is called to calculate the segment size based on the user's launch parameters
     static inline size_t calculate_reserved_sz();
     // This is called to calculate a large segment size for large arrays. It bumps size
     // to the MinRegionSize in order to reserved the most possible.
     inline size_t        calculate_large_reserved_sz(size_t size);
-    // Allocates the reserved_sz to the space and sets the appropriate pointers
-    inline container_t   install_container_in_space(size_t reserved_sz, size_t size);
+    // The largest segment the space hands out, either regular or extending a container.
+    inline size_t        max_segment_size() const;
+    // Adapts the size of the regular segments to the growth of the containers in the
+    // last GC. Called at the end of a scavenge, before the stats are reset.
+    void                 resize_segments();
 
     // Destructors --- these should only be called for the other's space, since for the rest
     // the leftover segments are to be pushed to the pool for reuse.
@@ -167,19 +284,29 @@ class MutableBDASpace : public MutableSpace
     // This is called during the final stage of OldGC when free segments are returned to the pool
     inline void add_to_pool(container_t c);
     inline bool not_in_pool(container_t c) const;
-    // This is called when a large segment requires that smaller segments in the pool
-    // need to be cleared away to make room for the new one.
+    // This is called when a segment is reserved over addresses whose descriptors were
+    // left in the pool.
     inline void remove_from_pool(container_t c);
+    // Takes the descriptors of the slots in [beg, end) out of the pool, when the
+    // range is given to another space.
+    void        release_pool(HeapWord * beg, HeapWord * end);
     
     // GC support
     inline container_t get_next_n_segment(container_t c, int n) const;
     inline container_t get_previous_n_segment(container_t c, int n) const;
     inline container_t get_container_with_addr(HeapWord * addr) const;
     inline container_t first_container() const { return _containers->peek(); }
+    GenQueueIterator<container_t, mtGC> containers_iterator() const { return _containers->iterator(); }
     container_t last_container() const  { return _containers->bot(); }
     container_t * last_container_addr() { return _containers->bot_addr(); }
     inline container_t last_before_gc() const  { return _last_segment; }
-    inline void        save_top_ptrs();
+    // Saves the top of every segment. With a card table, the segments without
+    // dirty cards are saved as empty and their bda summary is claimed.
+    inline void        save_top_ptrs(CardTableModRefBS * ct = NULL);
+    // Splits the segments saved with a non-empty top in chunks of chunk_words and
+    // stores them in chunks, or only counts them if chunks is NULL.
+    // Returns the number of chunks.
+    jint               scan_chunks(BDAScanChunk * chunks, size_t chunk_words) const;
 
     // Size computations (in heapwords and bytes)
     inline size_t used_in_words() const;
@@ -188,6 +315,22 @@ class MutableBDASpace : public MutableSpace
     inline size_t free_in_bytes() const;
     inline size_t fast_free_in_words() const;
     inline size_t fast_free_in_bytes() const;
+    // The words taken by segments, i.e., below the top and out of the spill, and
+    // the ones left for new segments, i.e., above the top and in the spill.
+    size_t        spill_free_in_words() const { return pointer_delta(_spill_end, _spill_top); }
+    // The words of the runs cached by the gc threads not yet taken by segments
+    size_t        cached_free_in_words() const;
+    size_t        reserved_words() const;
+    size_t        unreserved_words() const {
+      return space()->free_in_words() + spill_free_in_words() + cached_free_in_words();
+    }
+    // The words the space is expected to take until the next GC
+    size_t        expected_reserved_words() const { return (size_t)_avg_reserved->padded_average(); }
+    // Samples the words taken since the last GC. Called at the end of a scavenge.
+    void          sample_reserved_words();
+    // Restarts the sampling from the current words. Called at the end of a full GC,
+    // which frees the words of the dead objects.
+    void          reset_reserved_words() { _reserved_at_last_gc = reserved_words(); }
     
     // Iteration support
     void object_iterate_containers(ObjectClosure * cl);
@@ -201,6 +344,22 @@ class MutableBDASpace : public MutableSpace
 #endif
     
     // Statistics and printing
+    // Adds the words used by the segments placed on each node to words, which has
+    // one entry per node.
+    void used_per_numa_node(size_t * words) const;
+    // The deltas of the fragmentation stats recorded by the gc thread worker_id
+    inline BDAFragmentationStats * frag_deltas(uint worker_id);
+    // Adds the deltas of the gc threads to the fragmentation stats of the space.
+    // Called at the end of a scavenge.
+    void fold_fragmentation_stats();
+    // Recounts the fragmentation stats with a walk of the containers, numbering the
+    // segments of their chains again, and drops the deltas. Called at the end of a
+    // full GC, which rewrites the segments.
+    void recompute_fragmentation_stats();
+    const BDAFragmentationStats & fragmentation_stats() const { return _frag_stats; }
+    // The average fragmentation of the segments, i.e., the fraction of each one
+    // that is unused, and its variance, as of the last fold of the stats.
+    double container_fragmentation(double * var) const;
     void print_container_fragmentation_stats() const;
     void print_container_list(bool verbose = false) const;
     void print_allocation(container_t c, bool large = false) const;
@@ -214,8 +373,39 @@ class MutableBDASpace : public MutableSpace
 
  private:
   GrowableArray<CGRPSpace*>* _spaces;
-  ParMarkBitMap              _segment_bitmap;
+  // Bitmaps of the segments embedded in the other space, with one bit per MinRegionSize
+  // slot of the reserved heap. Segments span whole slots, so a segment starts at a slot
+  // set in _segment_beg_slots and ends at the last word of a slot set in
+  // _segment_end_slots, and the searches for segments look at one bit per slot instead
+  // of one per word (see get_next_beg_seg and get_next_end_seg).
+  BitMap                     _segment_beg_slots;
+  BitMap                     _segment_end_slots;
+  // The lgrp ids of the NUMA nodes the segments are placed on, indexed by the node
+  // numbers kept in the segments. Without BDANUMAPlacement there is a single node.
+  int *                      _numa_lgrp_ids;
+  int                        _numa_nodes;
   size_t                     _page_size;
+  // Side table of container descriptors, one per MinRegionSize slot of the reserved
+  // heap and in address order. Every segment spans at least one slot, so the
+  // descriptor of the segment starting at addr is the one of the slot addr is in.
+  container_t                _descriptors;
+  HeapWord *                 _descriptors_base;
+  size_t                     _descriptors_len;
+  // Snapshot of the segments with old-to-young refs to scan, taken at the start of a
+  // scavenge. Segments larger than BDAOldToYoungChunkSize cards are split into several
+  // chunks, which the gc threads claim by bumping a shared index, so that one large
+  // segment does not leave a single thread scanning while the others are idle.
+  BDAScanChunk *             _scan_chunks;
+  jint                       _scan_chunks_capacity;
+  jint                       _n_scan_chunks;
+  volatile jint              _next_scan_chunk;
+  // Words of the last shrink of the old space that were not shrinkable_bytes(),
+  // and are asked of the last bda-space at the next full GC (see prepare_shrink()).
+  size_t                     _shrink_wanted;
+  // Perf counters of the spaces, under sun.gc.bda
+  BDACounters *              _counters;
+  // Times of the bda phases of the last GC
+  BDAPhaseTimes *            _phase_times;
 
  protected:
 
@@ -226,9 +416,22 @@ class MutableBDASpace : public MutableSpace
   void update_layout(MemRegion mr);
   HeapWord* expand_overflown_neighbour(int i, size_t sz);
 
+  // The spaces are laid out in the order of their indexes, starting at 1, with the
+  // general object space (0) at the end. These return the index of the space right
+  // above (resp. below) space i, or -1 if there is none.
+  int  upper_neighbour(int i) const;
+  int  lower_neighbour(int i) const;
+  // The words of the free end of space i that it can give to its upper neighbour,
+  // keeping the room it is expected to need until the next GC, and those that may
+  // pass through it on their way up, keeping MinRegionSize of capacity.
+  size_t surplus_words(int i) const;
+  size_t passable_words(int i) const;
+
   // Expanding funtions
-  void expand_region_to_neighbour(int i, size_t sz);
-  bool try_fitting_on_neighbour(int moved_id);
+  // Grows space i by up to sz words, either at its end, through an empty upper
+  // neighbour, or at its bottom, through the free ends of the spaces below it.
+  // Returns the words it grew.
+  size_t expand_region_to_neighbour(int i, size_t sz);
   void initialize_regions(size_t space_size,
                           HeapWord* start,
                           HeapWord* end);
@@ -239,12 +442,13 @@ class MutableBDASpace : public MutableSpace
                                  size_t space_size);
   void merge_regions(int growee, int eater);
   void move_space_resize(MutableSpace* spc, HeapWord* to_ptr, size_t sz);
-  void shrink_and_adapt(int grp);
+  // Gives the last sz words of the free end of space grp to its upper neighbour,
+  // which then starts sz words lower, with a spill unless it is empty.
+  void shrink_and_adapt(int grp, size_t sz);
 
   // Increases of regions
   void increase_space_noclear(MutableSpace* spc, size_t sz);
   void increase_space_set_top(MutableSpace* spc, size_t sz, HeapWord* new_top);
-  void grow_through_neighbour(MutableSpace* growee, MutableSpace* eaten, size_t sz);
 
   // Shrinks of regions
   void shrink_space_clear(MutableSpace* spc, size_t sz);
@@ -255,6 +459,9 @@ class MutableBDASpace : public MutableSpace
   inline bool mark_container(container_t c);
   inline void unmark_container(container_t c);
   inline void allocate_block(HeapWord * obj);
+
+  // The node of the NUMA locality group lgrp_id, or node 0 if it is unknown
+  int numa_node_for_lgrp(int lgrp_id) const;
   
  public:
 
@@ -269,14 +476,44 @@ class MutableBDASpace : public MutableSpace
   void                       set_page_size(size_t page_size) { _page_size = page_size; }
   size_t                     page_size() const { return _page_size; }
   GrowableArray<CGRPSpace*>* spaces() const { return _spaces; }
-  ParMarkBitMap const *      segment_bitmap() const { return &_segment_bitmap; }
+  inline container_t         descriptor_at(HeapWord * addr) const;
+  // NUMA placement of the segments (see BDANUMAPlacement)
+  int                        numa_nodes() const { return _numa_nodes; }
+  int                        numa_lgrp_id(int node) const { return _numa_lgrp_ids[node]; }
+  // The node of the calling thread
+  int                        current_numa_node() const;
+  // The node of the thread that allocated root, i.e., of the eden chunk root is in,
+  // or the one of the calling thread if root is not in eden.
+  int                        numa_node_of(oop root) const;
+  // Biases the pages of the segments reserved at [ptr, ptr + sz) to node. The range
+  // must hold no objects, since its pages are freed.
+  void                       bias_segments(HeapWord * ptr, size_t sz, int node) const;
+  // The index of the slot addr is in, and the first address of a slot
+  inline size_t              slot_for(HeapWord * addr) const;
+  inline HeapWord *          slot_to_addr(size_t slot) const;
 
   container_t container_for_addr(HeapWord * addr);
   void          add_to_pool(container_t c, uint id);
-  inline void   save_tops_for_scavenge();
+  // Saves the tops of the segments and splits the ones to scan for old-to-young
+  // refs in chunks. Returns the number of chunks. Must be called at a safepoint,
+  // before the gc threads start claiming chunks.
+  jint          save_tops_for_scavenge(CardTableModRefBS * ct);
+  // Claims the next chunk to scan. Returns false if there are none left.
+  inline bool   claim_scan_chunk(BDAScanChunk & chunk);
+
+  // Selects the bda-spaces whose containers are rewritten into contiguous runs
+  // by the next full GC, based on their fragmentation.
+  void  select_spaces_to_defragment();
 
   // Statistics functions
   float avg_nsegments_in_bda();
+  // The top of segment c moved from old_top to new_top in a promotion of the gc
+  // thread worker_id, which records it in the fragmentation stats of its space.
+  inline void note_segment_top(container_t c, HeapWord * old_top, HeapWord * new_top,
+                               uint worker_id);
+  // See the CGRPSpace methods of the same names
+  void  fold_fragmentation_stats();
+  void  recompute_fragmentation_stats();
   
   
 
@@ -294,33 +531,53 @@ class MutableBDASpace : public MutableSpace
   // tops of the whole CGRPspaces
   bool update_top();
 
-  // This method adjusts the regions to give precedence to the one with the most
-  // occupancy rate, which indicates it to be the needy one
+  // Moves the boundaries between neighbouring spaces so that each bda-space has room
+  // for the words it is expected to take until the next GC, ahead of its exhaustion,
+  // which would overflow its containers into the general object space and bring on
+  // a full GC. With force, the most occupied bda-space also grows if its room is
+  // expected to last. Returns true if any boundary moved. Called at the end of a
+  // scavenge (see BDAAdaptiveSpaceLayout).
   bool adjust_layout(bool force);
+  // See the CGRPSpace methods of the same names
+  void sample_reserved_words();
+  void reset_reserved_words();
+  void retire_spills();
+
+  // The old space only shrinks over the free end of the general object space,
+  // which ends it, keeping MinRegionSize of capacity. These are the bytes it can
+  // shrink by.
+  size_t shrinkable_bytes() const;
+  void   set_shrink_wanted_bytes(size_t bytes) { _shrink_wanted = bytes / HeapWordSize; }
+  // Gives the general object space the free end of the last bda-space, up to the
+  // words the last shrink wanted beyond shrinkable_bytes(). Called during a full GC,
+  // after marking and before the summary, which then compacts the objects of the
+  // general object space down over that range, for the next resize to free it.
+  void   prepare_shrink();
   size_t compute_avg_freespace();
 
   // Accessors to spaces
   MutableSpace * non_bda_space() const { return non_bda_grp()->space(); }
   CGRPSpace    * non_bda_grp  () const { return _spaces->at(0); }
-  MutableSpace * region_for(BDARegion* region) const {
-    int i = _spaces->find(&region, CGRPSpace::equals);
-    return _spaces->at(i)->space();
+  // The space of a region, or the general object space for no region, is at its
+  // space id (see BDARegion).
+  CGRPSpace    * grp_for(BDARegion* region) const {
+    return _spaces->at(BDARegion::space_id(region));
   }
+  MutableSpace * region_for(BDARegion* region) const { return grp_for(region)->space(); }
 
   virtual HeapWord *top_specific(BDARegion* type) {
-    int i = _spaces->find(&type, CGRPSpace::equals);
-    return _spaces->at(i)->space()->top();
+    return grp_for(type)->space()->top();
   }
   virtual MemRegion used_region(BDARegion* type) {
-    int i = _spaces->find(&type, CGRPSpace::equals);
-    return _spaces->at(i)->space()->used_region();
+    return grp_for(type)->space()->used_region();
   }
   virtual int num_bda_regions() { return _spaces->length() - 1; }
 
   inline  int  container_count();
   inline  bool is_bdaspace_empty();
 
-  // Selection of bits for the beginning and ending of container segments, respectively
+  // Return the start (resp. last word) of the first segment of the other space that starts
+  // (resp. ends) within [beg, end), or end if there is none.
   inline HeapWord * get_next_beg_seg(HeapWord * beg, HeapWord * end) const;
   inline HeapWord * get_next_end_seg(HeapWord * beg, HeapWord * end) const;
 
@@ -346,10 +603,19 @@ class MutableBDASpace : public MutableSpace
   // Allocation methods
   virtual HeapWord* allocate(size_t size);
   virtual HeapWord* cas_allocate(size_t size);
-  container_t       allocate_container (size_t size, BDARegion * r);
-  // This version updates the container with a new one if a new segment was needed.
-  HeapWord*         allocate_element(size_t size, container_t& r);
-  HeapWord*         allocate_plab (container_t& container);
+  // The worker_id selects the segment cache of the calling gc thread, and node the
+  // NUMA node the container is placed on.
+  container_t       allocate_container (size_t size, BDARegion * r, uint worker_id,
+                                        int node = any_numa_node);
+  // This version updates the container with a new one if a new segment was needed,
+  // which is placed on the node of the container.
+  HeapWord*         allocate_element(size_t size, container_t& r, uint worker_id);
+  // The size of the lab is chosen by the lab of the promotion manager (see
+  // BDAOldPromotionLAB::desired_words)
+  HeapWord*         allocate_plab (container_t& container, size_t size, uint worker_id);
+  // See the CGRPSpace methods of the same names
+  void              retract_segment_caches();
+  void              retire_segment_caches();
 
   // Helper methods for scavenging
   virtual HeapWord* top_region_for_stripe(HeapWord* stripe_start) {
@@ -368,7 +634,13 @@ class MutableBDASpace : public MutableSpace
 
   // Clear and reset methods
   void         clear_delete_containers_in_space(uint space_id);
+  void         resize_segments();
   void         reset_grp_stats();     
+  // Perf counters support. The counters are updated at the end of each GC, before
+  // the stats of the spaces are reset.
+  void         initialize_performance_counters();
+  void         update_counters();
+  BDAPhaseTimes * phase_times() const { return _phase_times; }
   virtual void clear(bool mangle_space);
 
   // Setters
@@ -3,6 +3,8 @@
 
 # include "bda/mutableBDASpace.hpp"
 # include "oops/klassRegionMap.hpp"
+# include "memory/cardTableModRefBS.hpp"
+# include "utilities/bitMap.inline.hpp"
 
 
 
@@ -153,16 +155,6 @@
 //   }
 // }
 
-inline void
-MutableBDASpace::CGRPSpace::free_container(container_t container)
-{
-  // Assert that the container references no other.
-  assert (container->_prev_segment == NULL && container->_next_segment == NULL,
-          "segment associated with parent container");
-  memset(container, 0, sizeof(struct container));
-  _pool->enqueue(container);
-}
-
 inline size_t
 MutableBDASpace::CGRPSpace::calculate_reserved_sz()
 {
@@ -194,48 +186,27 @@ MutableBDASpace::CGRPSpace::calculate_reserved_sz()
   reserved_sz = (size_t) align_size_up((intptr_t)reserved_sz_bytes >> LogHeapWordSize,
                                        MutableBDASpace::MinRegionSize);
 
-  return reserved_sz;
+  return MAX2(reserved_sz, MutableBDASpace::MinRegionSize);
 }
 
 inline size_t
 MutableBDASpace::CGRPSpace::calculate_large_reserved_sz(size_t size)
 {
   size_t reserved_sz = 0;
-  reserved_sz = (size_t) align_size_up((intptr_t)size, segment_sz);
+  reserved_sz = (size_t) align_size_up((intptr_t)size, MutableBDASpace::MinRegionSize);
   return reserved_sz;
 }
 
-inline container_t
-MutableBDASpace::CGRPSpace::install_container_in_space(size_t reserved_sz, size_t size)
+inline size_t
+MutableBDASpace::CGRPSpace::max_segment_size() const
 {
-  HeapWord * ptr;
-  
-  // Now the amount of space is reserved with a CAS and the resulting ptr
-  // is returned as the start of the collection struct
-  
-  ptr = space()->cas_allocate(reserved_sz);
-
-  // If there's no space left to allocate a new container, then
-  // return NULL so that MutableBDASpace can handle the allocation
-  // of a new container to "other" space.
-  if (ptr == NULL) {
-    return (container_t)ptr;
-  }
-  
-  // We allocate it with the general AllocateHeap since struct is not, by default,
-  // subclass of one of the base VM classes (CHeap, ResourceObj, ... and friends).
-  // It must be initialized prior to allocation because there's no default constructor.
-  container_t container = (container_t)AllocateHeap(sizeof(struct container), mtGC);
-  container->_start = ptr; container->_top = ptr + size;
-  container->_end = ptr + reserved_sz - MutableBDASpace::_filler_header_size;
-  container->_next_segment = NULL; container->_next = NULL; container->_prev_segment = NULL;
-  container->_previous = NULL; container->_saved_top = NULL;
-  container->_space_id = (char)_type->value();
-  container->_hard_end = ptr + reserved_sz;
-
-  return container;
+  // No segment takes more than an eighth of the space, so that a few growing
+  // containers cannot exhaust it on their own.
+  const size_t max_sz = (size_t) align_size_down((intptr_t)(space()->capacity_in_words() / 8),
+                                                 MutableBDASpace::MinRegionSize);
+  return MAX2(max_sz, segment_sz);
 }
-  
+
 inline bool
 MutableBDASpace::CGRPSpace::clear_delete_containers()
 {
@@ -271,10 +242,9 @@ MutableBDASpace::CGRPSpace::clear_delete_containers()
 #endif // BDA_PARANOID
         c->_next_segment->_prev_segment = c->_prev_segment;
       }
-      // do this first, before enqueuing (it sets _next and _previous).
+      // The descriptor stays in the side table, ready for the next segment there.
       container_t n = c->_next;
       memset(c, 0, sizeof(struct container));
-      _pool->enqueue_no_mt(c);
       c = n;
     }
     GenQueue<container_t, mtGC>::destroy(_containers);
@@ -316,15 +286,17 @@ MutableBDASpace::CGRPSpace::add_to_pool(container_t c)
     assert (c->_top == c->_start, "container is not empty");
     memset(c, 0, sizeof(struct container));
     mask_container(c);
-    c->_space_id = (char)(exact_log2((intptr_t) _type->value()));
-    _pool->enqueue(c);
+    c->_space_id = (uint16_t)space_id();
+    Atomic::inc(&_pooled_segments);
   }
 }
 
 inline void
 MutableBDASpace::CGRPSpace::remove_from_pool (container_t c)
 {
-  _pool->remove_element_mt (c);
+  assert (!not_in_pool(c), "container is not in the pool");
+  memset(c, 0, sizeof(struct container));
+  Atomic::dec(&_pooled_segments);
 }
 
 inline int
@@ -362,19 +334,14 @@ MutableBDASpace::CGRPSpace::get_previous_n_segment(container_t c, int n) const
 inline container_t
 MutableBDASpace::CGRPSpace::get_container_with_addr(HeapWord* addr) const
 {
-  container_t c;
-  for (GenQueueIterator<container_t, mtGC> iterator = _containers->iterator();
-       *iterator != NULL;
-       ++iterator) {
-    c = *iterator;
-    if (addr == c->_start)
-      return c;
-  }
+  container_t c = _manager->descriptor_at(addr);
+  if (not_in_pool(c) && addr == c->_start)
+    return c;
   return NULL;
 }
 
 inline void
-MutableBDASpace::CGRPSpace::save_top_ptrs()
+MutableBDASpace::CGRPSpace::save_top_ptrs(CardTableModRefBS * ct)
 {
   if (container_count() > 0) {
     _last_segment = last_container();
@@ -383,9 +350,11 @@ MutableBDASpace::CGRPSpace::save_top_ptrs()
         ++iterator) {
       container_t c = *iterator;
       c->_saved_top = c->_top;
-#ifdef ASSERT
-      c->_scanned_flag = -1;
-#endif 
+      // A segment without dirty cards has no old-to-young refs: it is saved as
+      // empty, so that the scavenge skips it without looking at its cards.
+      if (ct != NULL && !ct->claim_bda_summary(c->_start, c->_hard_end)) {
+        c->_saved_top = c->_start;
+      }
     }
   } else {
     _last_segment = NULL;
@@ -449,9 +418,36 @@ MutableBDASpace::CGRPSpace::used_in_bytes() const
 {
   return used_in_words() * HeapWordSize;
 }
+inline BDAFragmentationStats *
+MutableBDASpace::CGRPSpace::frag_deltas(uint worker_id)
+{
+  assert (worker_id < ParallelGCThreads + 1, "worker id out of range");
+  return &_frag_deltas[worker_id];
+}
 /////////////////////////////////////////
 // MutableBDASpace inline Definitions////
 /////////////////////////////////////////
+inline container_t
+MutableBDASpace::descriptor_at(HeapWord * addr) const
+{
+  assert (_descriptors != NULL, "descriptor table not initialized");
+  const size_t slot = pointer_delta(addr, _descriptors_base) >> Log2MinRegionSize;
+  assert (slot < _descriptors_len, "address out of the reserved heap");
+  return _descriptors + slot;
+}
+
+inline size_t
+MutableBDASpace::slot_for(HeapWord * addr) const
+{
+  return pointer_delta(addr, _descriptors_base) >> Log2MinRegionSize;
+}
+
+inline HeapWord *
+MutableBDASpace::slot_to_addr(size_t slot) const
+{
+  return _descriptors_base + (slot << Log2MinRegionSize);
+}
+
 inline int
 MutableBDASpace::container_count()
 {
@@ -462,12 +458,18 @@ MutableBDASpace::container_count()
   return acc;
 }
 
-inline void
-MutableBDASpace::save_tops_for_scavenge()
+inline bool
+MutableBDASpace::claim_scan_chunk(BDAScanChunk & chunk)
 {
-  for (int i = 0; i < spaces()->length(); ++i) {
-    spaces()->at(i)->save_top_ptrs();
+  if (_next_scan_chunk >= _n_scan_chunks) {
+    return false;
+  }
+  jint i = Atomic::add(1, &_next_scan_chunk) - 1;
+  if (i >= _n_scan_chunks) {
+    return false;
   }
+  chunk = _scan_chunks[i];
+  return true;
 }
 
 inline bool
@@ -488,16 +490,19 @@ MutableBDASpace::is_bdaspace_empty()
 inline bool
 MutableBDASpace::mark_container(container_t c)
 {
-  return _segment_bitmap.mark_obj(c->_start, pointer_delta(c->_hard_end, c->_start));
+  assert (slot_to_addr(slot_for(c->_start)) == c->_start &&
+          slot_to_addr(slot_for(c->_hard_end)) == c->_hard_end,
+          "segments must span whole slots");
+  _segment_beg_slots.par_set_bit(slot_for(c->_start));
+  return _segment_end_slots.par_set_bit(slot_for(c->_hard_end - 1));
 }
 
-// This unmarks the container in the segment bitmap
+// This unmarks the container in the segment bitmaps
 inline void
 MutableBDASpace::unmark_container(container_t c)
 {
-  const idx_t beg_bit = _segment_bitmap.addr_to_bit (c->_start);
-  const idx_t end_bit = _segment_bitmap.addr_to_bit (c->_hard_end - 1);
-  _segment_bitmap.clear_range(beg_bit, end_bit);
+  _segment_beg_slots.par_clear_bit(slot_for(c->_start));
+  _segment_end_slots.par_clear_bit(slot_for(c->_hard_end - 1));
 }
 
 inline void
@@ -506,15 +511,34 @@ MutableBDASpace::allocate_block(HeapWord * obj)
   _start_array->allocate_block(obj);
 }
 
+inline void
+MutableBDASpace::note_segment_top(container_t c, HeapWord * old_top, HeapWord * new_top,
+                                  uint worker_id)
+{
+  BDAFragmentationStats * const deltas = spaces()->at((int)c->_space_id)->frag_deltas(worker_id);
+  deltas->update_fill(pointer_delta(old_top, c->_start), pointer_delta(new_top, c->_start),
+                      pointer_delta(c->_end, c->_start));
+}
+
 inline HeapWord *
 MutableBDASpace::get_next_beg_seg(HeapWord * beg, HeapWord * end) const
 {
-  _segment_bitmap.find_obj_beg(beg, end);
+  if (beg >= end) return end;
+  // The slots that start within [beg, end)
+  const size_t beg_slot = slot_for(beg + MinRegionSize - 1);
+  const size_t end_slot = slot_for(end + MinRegionSize - 1);
+  const size_t res_slot = _segment_beg_slots.get_next_one_offset(beg_slot, end_slot);
+  return res_slot < end_slot ? slot_to_addr(res_slot) : end;
 }
 
 inline HeapWord *
 MutableBDASpace::get_next_end_seg(HeapWord * beg, HeapWord * end) const
 {
-  _segment_bitmap.find_obj_end(beg, end);
+  if (beg >= end) return end;
+  // The slots whose last word is within [beg, end)
+  const size_t beg_slot = slot_for(beg);
+  const size_t end_slot = slot_for(end);
+  const size_t res_slot = _segment_end_slots.get_next_one_offset(beg_slot, end_slot);
+  return res_slot < end_slot ? slot_to_addr(res_slot + 1) - 1 : end;
 }
 #endif
@@ -1,16 +1,154 @@
 # include "bda/refqueue.hpp"
+# include "runtime/globals.hpp"
+# include "runtime/safepoint.hpp"
+# include "runtime/thread.hpp"
 
-Ref::Ref(oop obj, BDARegion * r) : _next(NULL),
-                                   _actual_ref(obj),
-                                   _region(r)
-{
-}
-
+#if defined(BDA) || defined(BDA_INTERPRETER)
 RefQueue*
 RefQueue::create()
 {
   RefQueue * queue = new RefQueue();
-  queue->set_insert_end(NULL);
-  queue->set_remove_end(NULL);
+  queue->_completed = NULL;
+  queue->_free_list = NULL;
+  // The flags are not parsed yet, the size is set with the first buffer.
+  queue->_buffer_sz = 0;
+  queue->_shared_lock = 0;
+  queue->_batches = NULL;
+  queue->_batches_capacity = 0;
+  queue->_n_batches = 0;
+  queue->_n_roots = 0;
+  queue->_next_batch = 0;
+  DEBUG_ONLY(queue->_n_completed = 0;)
   return queue;
 }
+
+void
+RefQueue::push(RefChunk * volatile * list, RefChunk * c)
+{
+  RefChunk * head = NULL;
+  do {
+    head = *list;
+    c->set_next(head);
+  } while (Atomic::cmpxchg_ptr(c, list, head) != head);
+}
+
+RefChunk*
+RefQueue::pop(RefChunk * volatile * list)
+{
+  RefChunk * head = NULL;
+  do {
+    head = *list;
+    if (head == NULL)
+      return NULL;
+  } while (Atomic::cmpxchg_ptr(head->next(), list, head) != head);
+  head->set_next(NULL);
+  return head;
+}
+
+void**
+RefQueue::allocate_buffer()
+{
+  assert (sizeof(Ref) == (size_t)BDARootBuffer::entry_size_in_bytes(),
+          "the layout of Ref must match the entries logged by the mutators");
+  if (_buffer_sz == 0) {
+    // Racing threads all write the same value
+    _buffer_sz = BDARootBufferSize * sizeof(Ref);
+  }
+  RefChunk * c = pop(&_free_list);
+  if (c == NULL) {
+    char * mem = NEW_C_HEAP_ARRAY(char, RefChunk::aligned_size() + _buffer_sz, mtGC);
+    c = (RefChunk*)mem;
+    c->set_next(NULL);
+  }
+  c->set_index(_buffer_sz);
+  return RefChunk::make_buffer_from_chunk(c);
+}
+
+void
+RefQueue::deallocate_buffer(void ** buf)
+{
+  FREE_C_HEAP_ARRAY(char, (char*)RefChunk::make_chunk_from_buffer(buf), mtGC);
+}
+
+void
+RefQueue::enqueue_completed_buffer(void ** buf, size_t index)
+{
+  assert (index <= _buffer_sz, "index out of bounds");
+  RefChunk * c = RefChunk::make_chunk_from_buffer(buf);
+  c->set_index(index);
+  push(&_completed, c);
+  DEBUG_ONLY(Atomic::inc(&_n_completed);)
+}
+
+void
+RefQueue::recycle_chunk(RefChunk * c)
+{
+  assert (SafepointSynchronize::is_at_safepoint(), "must be at a safepoint");
+  DEBUG_ONLY(Atomic::dec(&_n_completed);)
+  push(&_free_list, c);
+}
+
+void
+RefQueue::enqueue(oop obj, BDARegion * r)
+{
+  Thread::SpinAcquire(&_shared_lock, "BDASharedRootBuffer");
+  _shared_buffer.enqueue(obj, r);
+  Thread::SpinRelease(&_shared_lock);
+}
+
+void
+RefQueue::flush_shared_buffer()
+{
+  assert (SafepointSynchronize::is_at_safepoint(), "must be at a safepoint");
+  _shared_buffer.flush();
+}
+
+jint
+RefQueue::prepare_batches()
+{
+  assert (SafepointSynchronize::is_at_safepoint(), "must be at a safepoint");
+  const size_t batch_sz = MAX2(BDARefRootsBatchSize, (uintx)1) * sizeof(Ref);
+
+  jint n = 0;
+  jint roots = 0;
+  for (RefChunk * c = _completed; c != NULL; c = c->next()) {
+    n += (jint)((_buffer_sz - c->index() + batch_sz - 1) / batch_sz);
+    roots += (jint)((_buffer_sz - c->index()) / sizeof(Ref));
+  }
+  if (n > _batches_capacity) {
+    if (_batches != NULL) {
+      FREE_C_HEAP_ARRAY(RefBatch, _batches, mtGC);
+    }
+    _batches_capacity = MAX2(n, 2 * _batches_capacity);
+    _batches = NEW_C_HEAP_ARRAY(RefBatch, _batches_capacity, mtGC);
+  }
+
+  jint i = 0;
+  for (RefChunk * c = _completed; c != NULL; c = c->next()) {
+    Ref * const end = (Ref*)((char*)RefChunk::make_buffer_from_chunk(c) + _buffer_sz);
+    for (Ref * r = c->first_ref(); r < end; r = (Ref*)((char*)r + batch_sz)) {
+      _batches[i++] = RefBatch(r, MIN2((Ref*)((char*)r + batch_sz), end));
+    }
+  }
+  assert (i == n, "every root must belong to a batch");
+  _n_batches = n;
+  _n_roots = roots;
+  _next_batch = 0;
+  return n;
+}
+
+bool
+RefQueue::clear()
+{
+  assert (SafepointSynchronize::is_at_safepoint(), "must be at a safepoint");
+  // Every chunk is reused instead of leaked, whether or not it was drained.
+  RefChunk * c = NULL;
+  while ((c = pop(&_completed)) != NULL) {
+    recycle_chunk(c);
+  }
+  _n_batches = 0;
+  _next_batch = 0;
+  assert (_n_completed == 0, "every completed chunk must have been recycled");
+  return true;
+}
+#endif // BDA || BDA_INTERPRETER
@@ -4,34 +4,116 @@
 # include "memory/allocation.hpp"
 # include "oops/oopsHierarchy.hpp"
 # include "bda/bdaGlobals.hpp"
+# include "bda/bdaRootBuffer.hpp"
 # include "runtime/atomic.inline.hpp"
 # include "utilities/taskqueue.hpp"
 
-class Ref : public CHeapObj<mtGC> {
+//
+// Ref is an entry of a bda root buffer (see bdaRootBuffer.hpp): a newly allocated
+// container and the region of its klass. The layout must match the one used by the
+// interpreter and the compilers when logging roots, i.e., [oop, BDARegion*].
+//
+class Ref VALUE_OBJ_CLASS_SPEC {
 
  private:
-  Ref *       _next;
   oop         _actual_ref;
   BDARegion * _region;
 
  public:
 
-  Ref(oop obj, BDARegion * r);
-
-  Ref * next()            { return _next; }
-  void set_next(Ref* ref) { _next = ref; }
-
   oop         ref()                { return _actual_ref; }
   oop *       ref_addr()           { return &_actual_ref; }
   BDARegion * region () const      { return _region; }
 };
 
+//
+// RefChunk is the header of each buffer handed to the threads. It lies just before
+// the buffer, in a similar fashion to BufferNode (see g1/ptrQueue.hpp), so that the
+// mutators only deal with the buffer itself.
+//
+class RefChunk VALUE_OBJ_CLASS_SPEC {
+
+ private:
+  RefChunk * _next;
+  // The byte index of the first logged Ref. The buffer is filled from its end.
+  size_t     _index;
+
+ public:
+
+  RefChunk * next () const        { return _next; }
+  void set_next (RefChunk * c)    { _next = c; }
+  size_t index () const           { return _index; }
+  void set_index (size_t index)   { _index = index; }
+
+  static size_t aligned_size () {
+    return align_size_up(sizeof(RefChunk), sizeof(Ref));
+  }
+  static RefChunk * make_chunk_from_buffer (void ** buf) {
+    return (RefChunk*)((char*)buf - aligned_size());
+  }
+  static void ** make_buffer_from_chunk (RefChunk * c) {
+    return (void**)((char*)c + aligned_size());
+  }
+  Ref * first_ref () {
+    return (Ref*)((char*)make_buffer_from_chunk(this) + _index);
+  }
+};
+
+//
+// RefBatch is a range of Refs, within one chunk, claimed at once by a gc thread.
+//
+class RefBatch VALUE_OBJ_CLASS_SPEC {
+
+ private:
+  Ref * _begin;
+  Ref * _end;
+
+ public:
+
+  RefBatch () : _begin(NULL), _end(NULL) { }
+  RefBatch (Ref * begin, Ref * end) : _begin(begin), _end(end) { }
+
+  Ref * begin () const { return _begin; }
+  Ref * end   () const { return _end; }
+};
+
+//
+// RefQueue is the set of completed bda root buffers, which each JavaThread fills
+// while allocating containers. When a thread's buffer overflows it is pushed on
+// the lock-free list of completed chunks and the thread grabs a recycled one, so
+// neither a malloc nor a CAS on a shared location is needed for each container.
+// At the start of a scavenge the completed chunks are split into batches of at most
+// BDARefRootsBatchSize roots, which the gc threads claim by bumping a shared index
+// (see BDARefRootsTask). The chunks go back to the free list at the end of the GC.
+//
+// Pushes of completed chunks may race with each other, but pops only happen at a
+// safepoint. Conversely, pops from the free list happen at runtime and pushes only
+// at a safepoint, so none of the lists suffer from the ABA problem.
+//
 class RefQueue : public CHeapObj<mtGC> {
 
  private:
-  Ref * _insert_end;
-  Ref * _remove_end;
-  DEBUG_ONLY(int _n_elements;)
+  RefChunk * volatile _completed;
+  RefChunk * volatile _free_list;
+  // The size in bytes of the buffers (without the RefChunk header)
+  size_t              _buffer_sz;
+  // Buffer and lock used by threads other than JavaThreads, which are rare.
+  BDARootBuffer       _shared_buffer;
+  volatile int        _shared_lock;
+  // Snapshot of the completed chunks, taken at the start of a scavenge
+  RefBatch *          _batches;
+  jint                _batches_capacity;
+  jint                _n_batches;
+  // Number of roots in the snapshot of the last scavenge, for the perf counters
+  jint                _n_roots;
+  volatile jint       _next_batch;
+  DEBUG_ONLY(volatile jint _n_completed;)
+
+  static void push (RefChunk * volatile * list, RefChunk * c);
+  static RefChunk * pop (RefChunk * volatile * list);
+
+  // Returns a drained chunk to the free list. GC only.
+  void recycle_chunk (RefChunk * c);
 
  public:
 
@@ -39,79 +121,51 @@ class RefQueue : public CHeapObj<mtGC> {
     element = 0,
     container = 1
   };
-  
+
   // Factory methods
   static RefQueue * create();
 
-  // Methods for modification of the queue
-  inline void  enqueue(oop obj, BDARegion * r);
-  inline Ref * dequeue();
-  inline bool  clear();
-  inline Ref * peek()       { return _remove_end; }
-  inline bool  is_empty();
-
- protected:
-  
-  inline void set_insert_end(Ref* ref) { _insert_end = ref; }
-  inline void set_remove_end(Ref* ref) { _remove_end = ref; }
-  inline Ref * insert_end() { return _insert_end; }
-  inline Ref * remove_end() { return _remove_end; }
-  
+  size_t buffer_size () const { return _buffer_sz; }
+
+  // Hands a new (or recycled) buffer to a thread
+  void ** allocate_buffer ();
+  // Frees a buffer that was never completed
+  void    deallocate_buffer (void ** buf);
+  // Publishes the roots logged in buf from byte index onwards
+  void    enqueue_completed_buffer (void ** buf, size_t index);
+
+  // Splits the completed chunks in batches and returns their number. Must be called
+  // at a safepoint, before the gc threads start claiming batches.
+  jint    prepare_batches ();
+  // Claims the next batch of roots. Returns false if there are none left.
+  inline bool claim_batch (RefBatch & batch);
+  // The number of roots split in batches by the last prepare_batches
+  jint        roots_count () const { return _n_roots; }
+
+  // Logs a root allocated by a thread other than a JavaThread
+  void  enqueue(oop obj, BDARegion * r);
+  // Completes the shared buffer. Must be called at a safepoint.
+  void  flush_shared_buffer();
+  // Recycles every completed chunk. Must be called at a safepoint, once the
+  // roots are no longer needed.
+  bool  clear();
+  bool  is_empty() const { return _completed == NULL; }
 };
 
 // Inline definitions
 
-inline void
-RefQueue::enqueue(oop obj, BDARegion * r)
-{
-  Ref * ref = new Ref(obj, r);
-  Ref * temp = NULL;
-  do {
-    temp = insert_end();    
-  } while(Atomic::cmpxchg_ptr(ref,
-                              &_insert_end,
-                              temp) != temp);
-  if (temp != NULL) temp->set_next(ref);
-  if (remove_end() == NULL) set_remove_end(ref);
-  DEBUG_ONLY(Atomic::inc(&_n_elements);)
-}
-
-inline Ref*
-RefQueue::dequeue()
-{  
-  Ref * temp = NULL;
-  Ref * next = NULL;
-  do {
-    temp = remove_end();
-    if (temp == NULL)
-      return temp;
-    next = temp->next();
-  } while(Atomic::cmpxchg_ptr(next,
-                              &_remove_end,
-                              temp) != temp);
-  // This works just because there are no enqueue/dequeue at the same
-  // time, i.e., GC threads dequeue during STW GC Pause and Java threads
-  // enqueue at runtime. If it turns out to exist simultaneous enqueues/dequeues
-  // then there must be a membar in between this calls or else the remove_end() may
-  // be null at one time, before another thread that enqueued a Ref sets the remove_end() value.
-  if(remove_end() == NULL) set_insert_end(NULL);
-  DEBUG_ONLY(Atomic::dec(&_n_elements);)
-  return temp;
-}
-
-// TODO: Implement caching mechanism!
 inline bool
-RefQueue::clear()
+RefQueue::claim_batch(RefBatch & batch)
 {
-  set_insert_end(NULL);
-  set_remove_end(NULL);
-  DEBUG_ONLY(_n_elements = 0;)
+  if (_next_batch >= _n_batches) {
+    return false;
+  }
+  jint i = Atomic::add(1, &_next_batch) - 1;
+  if (i >= _n_batches) {
+    return false;
+  }
+  batch = _batches[i];
   return true;
 }
 
-inline bool
-RefQueue::is_empty()
-{
-  return insert_end() == NULL && remove_end() == NULL;
-}
 #endif // SHARE_VM_BDA_REFQUEUE_HPP
@@ -1402,6 +1402,17 @@ void LIR_List::allocate_object(LIR_Opr dst, LIR_Opr t1, LIR_Opr t2, LIR_Opr t3,
                            stub));
 }
 
+#if defined(BDA) || defined(BDA_INTERPRETER)
+void LIR_List::allocate_bda_object(LIR_Opr dst, LIR_Opr t1, LIR_Opr t2, LIR_Opr t3, LIR_Opr t4,
+                                   int header_size, int object_size, LIR_Opr klass, bool init_check,
+                                   CodeStub* stub, BDARegion* region) {
+  LIR_OpAllocObj* op = new LIR_OpAllocObj(klass, dst, t1, t2, t3, t4,
+                                          header_size, object_size, init_check, stub);
+  op->set_bda_region(region);
+  append(op);
+}
+#endif
+
 void LIR_List::allocate_array(LIR_Opr dst, LIR_Opr len, LIR_Opr t1,LIR_Opr t2, LIR_Opr t3,LIR_Opr t4, BasicType type, LIR_Opr klass, CodeStub* stub) {
   append(new LIR_OpAllocArray(
                            klass,
@@ -1527,6 +1527,9 @@ class LIR_OpAllocObj : public LIR_Op1 {
   int     _obj_size;
   CodeStub* _stub;
   bool    _init_check;
+#if defined(BDA) || defined(BDA_INTERPRETER)
+  BDARegion* _bda_region;  // region of the klass, if it is a bda klass
+#endif
 
  public:
   LIR_OpAllocObj(LIR_Opr klass, LIR_Opr result,
@@ -1540,7 +1543,11 @@ class LIR_OpAllocObj : public LIR_Op1 {
     , _hdr_size(hdr_size)
     , _obj_size(obj_size)
     , _init_check(init_check)
-    , _stub(stub)                                { }
+    , _stub(stub)
+#if defined(BDA) || defined(BDA_INTERPRETER)
+    , _bda_region(NULL)
+#endif
+                                                 { }
 
   LIR_Opr klass()        const                   { return in_opr();     }
   LIR_Opr obj()          const                   { return result_opr(); }
@@ -1552,6 +1559,10 @@ class LIR_OpAllocObj : public LIR_Op1 {
   int     object_size()  const                   { return _obj_size;    }
   bool    init_check()   const                   { return _init_check;  }
   CodeStub* stub()       const                   { return _stub;        }
+#if defined(BDA) || defined(BDA_INTERPRETER)
+  BDARegion* bda_region() const                  { return _bda_region;  }
+  void set_bda_region(BDARegion* r)              { _bda_region = r;     }
+#endif
 
   virtual void emit_code(LIR_Assembler* masm);
   virtual LIR_OpAllocObj * as_OpAllocObj () { return this; }
@@ -2226,6 +2237,9 @@ class LIR_List: public CompilationResourceObj {
   void irem(LIR_Opr left, int   right, LIR_Opr res, LIR_Opr tmp, CodeEmitInfo* info);
 
   void allocate_object(LIR_Opr dst, LIR_Opr t1, LIR_Opr t2, LIR_Opr t3, LIR_Opr t4, int header_size, int object_size, LIR_Opr klass, bool init_check, CodeStub* stub);
+#if defined(BDA) || defined(BDA_INTERPRETER)
+  void allocate_bda_object(LIR_Opr dst, LIR_Opr t1, LIR_Opr t2, LIR_Opr t3, LIR_Opr t4, int header_size, int object_size, LIR_Opr klass, bool init_check, CodeStub* stub, BDARegion* region);
+#endif
   void allocate_array(LIR_Opr dst, LIR_Opr len, LIR_Opr t1,LIR_Opr t2, LIR_Opr t3,LIR_Opr t4, BasicType type, LIR_Opr klass, CodeStub* stub);
 
   // jump is an unconditional branch
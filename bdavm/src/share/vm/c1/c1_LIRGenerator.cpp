@@ -679,12 +679,35 @@ void LIRGenerator::new_instance(LIR_Opr dst, ciInstanceKlass* klass, bool is_unr
 
     Runtime1::StubID stub_id = klass->is_initialized() ? Runtime1::fast_new_instance_id : Runtime1::fast_new_instance_init_check_id;
 
+#if defined(BDA) || defined(BDA_INTERPRETER)
+    // The region of a loaded klass is fixed, so only containers pay for the
+    // root registration, which is emitted inline on the fast path. The region
+    // of an allocation site overrides the one of the klass.
+    BDARegion* region = NULL;
+    if (UseBDA) {
+      ValueStack* state = info->stack();
+      region = state->scope()->method()->bda_region_at(state->bci(), klass->bda_region());
+      if (region != klass->bda_region()) {
+        // The fast stubs register roots by klass, so let the runtime do it.
+        stub_id = Runtime1::new_instance_id;
+      }
+    }
+#endif
+
     CodeStub* slow_path = new NewInstanceStub(klass_reg, dst, klass, info, stub_id);
 
     assert(klass->is_loaded(), "must be loaded");
     // allocate space for instance
     assert(klass->size_helper() >= 0, "illegal instance size");
     const int instance_size = align_object_size(klass->size_helper());
+#if defined(BDA) || defined(BDA_INTERPRETER)
+    if (region != NULL) {
+      __ allocate_bda_object(dst, scratch1, scratch2, scratch3, scratch4,
+                             oopDesc::header_size(), instance_size, klass_reg, !klass->is_initialized(), slow_path,
+                             region);
+      return;
+    }
+#endif
     __ allocate_object(dst, scratch1, scratch2, scratch3, scratch4,
                        oopDesc::header_size(), instance_size, klass_reg, !klass->is_initialized(), slow_path);
   } else {
@@ -1616,6 +1639,34 @@ void LIRGenerator::CardTableModRef_post_barrier(LIR_OprDesc* addr, LIR_OprDesc*
                               T_BYTE));
   }
 #endif
+#ifdef BDA
+  CardTableModRefBS* ct = (CardTableModRefBS*)_bs;
+  if (ct->bda_summary_base != NULL) {
+    // Dirty the bda summary entry of the card as well (see cardTableModRefBS.hpp),
+    // unless it is dirty already, like the interpreter does.
+    LIR_Const* summary_base = new LIR_Const(ct->bda_summary_base);
+    LIR_Opr summary_tmp = new_pointer_register();
+    if (TwoOperandLIRForm) {
+      __ move(addr, summary_tmp);
+      __ unsigned_shift_right(summary_tmp, CardTableModRefBS::bda_summary_shift, summary_tmp);
+    } else {
+      __ unsigned_shift_right(addr, CardTableModRefBS::bda_summary_shift, summary_tmp);
+    }
+    LIR_Address* summary_addr;
+    if (can_inline_as_constant(summary_base)) {
+      summary_addr = new LIR_Address(summary_tmp, summary_base->as_jint(), T_BYTE);
+    } else {
+      summary_addr = new LIR_Address(summary_tmp, load_constant(summary_base), T_BYTE);
+    }
+    LabelObj* L_already_dirty = new LabelObj();
+    LIR_Opr summary_val = new_register(T_INT);
+    __ move(summary_addr, summary_val);
+    __ cmp(lir_cond_equal, summary_val, LIR_OprFact::intConst(0));
+    __ branch(lir_cond_equal, T_INT, L_already_dirty->label());
+    __ move(LIR_OprFact::intConst(0), summary_addr);
+    __ branch_destination(L_already_dirty->label());
+  }
+#endif // BDA
 }
 
 
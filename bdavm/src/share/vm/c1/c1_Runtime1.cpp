@@ -196,6 +196,7 @@ void Runtime1::generate_blob_for(BufferBlob* buffer_blob, StubID id) {
   switch (id) {
     // These stubs don't need to have an oopmap
     case dtrace_object_alloc_id:
+    case bda_enqueue_root_id:
     case g1_pre_barrier_slow_id:
     case g1_post_barrier_slow_id:
     case slow_subtype_check_id:
@@ -316,6 +317,11 @@ JRT_ENTRY(void, Runtime1::new_instance(JavaThread* thread, Klass* klass))
   h->check_valid_for_instantiation(true, CHECK);
   // make sure klass is initialized
   h->initialize(CHECK);
+#if defined(BDA) || defined(BDA_INTERPRETER)
+  // The caller is compiled, so its site is only looked up for the klasses of sites
+  BDAAllocSiteMark site_mark(thread, UseBDA && KlassRegionMap::is_site_klass(h()) ?
+                             KlassRegionMap::site_region_of_caller(thread) : NULL);
+#endif
   // allocate instance and return via TLS
   oop obj = h->allocate_instance(CHECK);
   thread->set_vm_result(obj);
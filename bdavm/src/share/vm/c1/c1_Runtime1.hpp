@@ -39,6 +39,7 @@ class StubAssembler;
 
 #define RUNTIME1_STUBS(stub, last_entry) \
   stub(dtrace_object_alloc)          \
+  stub(bda_enqueue_root)             \
   stub(unwind_exception)             \
   stub(forward_exception)            \
   stub(throw_range_check_failed)       /* throws ArrayIndexOutOfBoundsException */ \
@@ -62,6 +62,10 @@ ciInstanceKlass::ciInstanceKlass(KlassHandle h_k) :
 
   _implementor = NULL; // we will fill these lazily
 
+#if defined(BDA) || defined(BDA_INTERPRETER)
+  _bda_region = ik->bda_region();
+#endif
+
   Thread *thread = Thread::current();
   if (ciObjectFactory::is_initialized()) {
     _loader = JNIHandles::make_local(thread, ik->class_loader());
@@ -106,6 +110,9 @@ ciInstanceKlass::ciInstanceKlass(ciSymbol* name,
   _super = NULL;
   _java_mirror = NULL;
   _field_cache = NULL;
+#if defined(BDA) || defined(BDA_INTERPRETER)
+  _bda_region = NULL;
+#endif
 }
 
 
@@ -29,6 +29,9 @@
 #include "ci/ciFlags.hpp"
 #include "ci/ciKlass.hpp"
 #include "ci/ciSymbol.hpp"
+#if defined(BDA) || defined(BDA_INTERPRETER)
+#include "bda/bdaGlobals.hpp"
+#endif
 
 // ciInstanceKlass
 //
@@ -73,6 +76,12 @@ private:
 
   GrowableArray<ciField*>* _non_static_fields;
 
+#if defined(BDA) || defined(BDA_INTERPRETER)
+  // The bda-region of the klass, or NULL if it is not a bda klass. The
+  // region is set when the klass is parsed and never changes afterwards.
+  BDARegion*             _bda_region;
+#endif
+
 protected:
   ciInstanceKlass(KlassHandle h_k);
   ciInstanceKlass(ciSymbol* name, jobject loader, jobject protection_domain);
@@ -177,6 +186,13 @@ public:
     return _has_default_methods;
   }
 
+#if defined(BDA) || defined(BDA_INTERPRETER)
+  BDARegion* bda_region() {
+    assert(is_loaded(), "must be loaded");
+    return _bda_region;
+  }
+#endif
+
   ciInstanceKlass* get_canonical_holder(int offset);
   ciField* get_field_by_offset(int field_offset, bool is_static);
   ciField* get_field_by_name(ciSymbol* name, ciSymbol* signature, bool is_static);
@@ -57,6 +57,9 @@
 #include "ci/ciTypeFlow.hpp"
 #include "oops/method.hpp"
 #endif
+#if defined(BDA) || defined(BDA_INTERPRETER)
+#include "oops/klassRegionMap.hpp"
+#endif
 
 // ciMethod
 //
@@ -947,6 +950,22 @@ bool ciMethod::is_compiled_lambda_form() const {
   return iid == vmIntrinsics::_compiledLambdaForm;
 }
 
+#if defined(BDA) || defined(BDA_INTERPRETER)
+// ------------------------------------------------------------------
+// ciMethod::bda_region_at
+//
+// The sites of a method are set when its holder is parsed, so they
+// never change while it is being compiled.
+BDARegion* ciMethod::bda_region_at(int bci, BDARegion* klass_region) {
+  if (!KlassRegionMap::has_alloc_sites()) {
+    return klass_region;
+  }
+  check_is_loaded();
+  VM_ENTRY_MARK;
+  return KlassRegionMap::region_for_site(klass_region, get_Method()->bda_region_at(bci));
+}
+#endif
+
 // ------------------------------------------------------------------
 // ciMethod::has_member_arg
 //
@@ -290,6 +290,12 @@ class ciMethod : public ciMetadata {
   bool is_compiled_lambda_form() const;
   bool has_member_arg() const;
 
+#if defined(BDA) || defined(BDA_INTERPRETER)
+  // The region of the object allocated at bci, given the region of its klass
+  // (see KlassRegionMap::region_for_site).
+  BDARegion* bda_region_at(int bci, BDARegion* klass_region);
+#endif
+
   // What kind of ciObject is this?
   bool is_method() const                         { return true; }
 
@@ -717,65 +717,80 @@ HeapWord* CardTableExtension::lowest_prev_committed_start(int ind) const {
 }
 
 #ifdef BDA
+// Scans the dirty cards of the chunk [slice_start, slice_end) of a segment saved at
+// the start of the scavenge. As in scavenge_contents_parallel, the objects that start
+// within the chunk belong to it, hence the last one may extend the cards scanned past
+// slice_end, and the cards at both ends of the chunk are not cleaned.
 void
 CardTableExtension::scavenge_bda_contents_parallel(ObjectStartArray * start_array,
                                                    container_t c,
-                                                   HeapWord * c_top,
+                                                   HeapWord * slice_start,
+                                                   HeapWord * slice_end,
                                                    PSPromotionManager * pm)
 {
-  assert (c->_start < c_top, "Should not be called if empty");
-  oop * sp_top = (oop*)c_top;
-  jbyte * start_card = byte_for(c->_start);
+  assert (c->_start <= slice_start && slice_start < slice_end && slice_end <= c->_saved_top,
+          "the chunk must be within the saved segment");
+  oop * sp_top = (oop*)c->_saved_top;
   jbyte * end_card = byte_for(sp_top - 1) + 1;
+  jbyte * start_card = byte_for(slice_start);
+  jbyte * worker_end_card = byte_for(slice_end - 1) + 1;
   oop * last_scanned = NULL;
 
-  // Set the limits and iterate the cards between the container's live words
-  
-  HeapWord * slice_start = addr_for(start_card);
-  HeapWord * slice_end = MIN2((HeapWord*)c_top, addr_for(end_card));
+  // If there are no objects starting within the chunk, the object spanning
+  // it is scanned by the chunk it starts in.
+  if (!start_array->object_starts_in_range(slice_start, slice_end)) {
+    return;
+  }
 
   // Update the beginning address. Don't go below the container's start.
   HeapWord * first_object = start_array->object_start(slice_start, c->_start);
   debug_only (oop * first_object_within_slice = (oop*) first_object;)
-    if (first_object < slice_start) {
-      last_scanned = (oop*) first_object + oop(first_object)->size();
-      debug_only (first_object_within_slice = last_scanned;)
-        start_card = byte_for (last_scanned);
-    }
+  if (first_object < slice_start) {
+    last_scanned = (oop*) first_object + oop(first_object)->size();
+    debug_only (first_object_within_slice = last_scanned;)
+    start_card = byte_for (last_scanned);
+  }
 
   // Update the ending addr
-  if (slice_end < (HeapWord*)c_top) {
+  if (slice_end < (HeapWord*)sp_top) {
+    // The subtraction is important! An object may start precisely at slice_end.
     HeapWord * last_object = start_array->object_start(slice_end - 1, c->_start);
     slice_end = last_object + oop(last_object)->size();
+    // worker_end_card is exclusive, so bump it one past the end of last_object's
+    // covered span.
+    worker_end_card = byte_for(slice_end) + 1;
+
+    if (worker_end_card > end_card)
+      worker_end_card = end_card;
   }
 
-  assert (slice_end <= c_top, "Last object in slice crosses space boundary");
+  assert (slice_end <= (HeapWord*)sp_top, "Last object in slice crosses space boundary");
   assert (is_valid_card_address (start_card), "Invalid start_card");
-  assert (is_valid_card_address (end_card), "Invalid end_card");
-  assert (start_card <= end_card, "worker start card beyond end card");
+  assert (is_valid_card_address (worker_end_card), "Invalid worker_end_card");
+  assert (worker_end_card <= end_card, "worker end card beyond end card");
 
   jbyte * current_card = start_card;
-  while (current_card < end_card) {
+  while (current_card < worker_end_card) {
     // Find an unclean card
-    while (current_card < end_card && card_is_clean(*current_card)) {
+    while (current_card < worker_end_card && card_is_clean(*current_card)) {
       current_card++;
     }
     jbyte * first_unclean_card = current_card;
 
     // Now, find a contiguous set of unclean cards
-    while (current_card < end_card && !card_is_clean(*current_card)) {
-      while (current_card < end_card && !card_is_clean(*current_card)) {
+    while (current_card < worker_end_card && !card_is_clean(*current_card)) {
+      while (current_card < worker_end_card && !card_is_clean(*current_card)) {
         current_card++;
       }
 
-      if (current_card < end_card) {
+      if (current_card < worker_end_card) {
         HeapWord * last_object_in_dirty_region = start_array->object_start (
           addr_for (current_card) - 1, c->_start);
         size_t size_of_last_object = oop (last_object_in_dirty_region)->size();
         HeapWord * end_of_last_object = last_object_in_dirty_region + size_of_last_object;
         jbyte * ending_card_of_last_object = byte_for (end_of_last_object);
 
-        assert (ending_card_of_last_object <= end_card,
+        assert (ending_card_of_last_object <= worker_end_card,
                 "ending_card_of_last_object has crossed the scanning boundary");
 
         if (ending_card_of_last_object > current_card) {
@@ -787,10 +802,9 @@ CardTableExtension::scavenge_bda_contents_parallel(ObjectStartArray * start_arra
       
     jbyte * following_clean_card = current_card;
 
-    if (first_unclean_card < end_card) {
+    if (first_unclean_card < worker_end_card) {
       oop * p = (oop*) start_array->object_start(addr_for(first_unclean_card),
                                                  c->_start);
-      // assert ((HeapWord*)p <= addr_for(first_unclean_card), "just checking");
       assert ((p >= last_scanned) ||
               (last_scanned == first_object_within_slice),
               "Should not be possible!");
@@ -802,6 +816,7 @@ CardTableExtension::scavenge_bda_contents_parallel(ObjectStartArray * start_arra
       }
       oop * to = (oop*) addr_for (following_clean_card);
 
+      // Test slice_end first!
       if ((HeapWord*)to > slice_end) {
         to = (oop*)slice_end;
       } else if (to > sp_top) {
@@ -811,8 +826,8 @@ CardTableExtension::scavenge_bda_contents_parallel(ObjectStartArray * start_arra
       // clear the cards
       if (first_unclean_card <= start_card + 1)
         first_unclean_card = start_card + 1;
-      if (following_clean_card >= end_card - 1)
-        following_clean_card = end_card - 1;
+      if (following_clean_card >= worker_end_card - 1)
+        following_clean_card = worker_end_card - 1;
 
       while (first_unclean_card < following_clean_card) {
         *first_unclean_card++ = clean_card;
@@ -828,7 +843,7 @@ CardTableExtension::scavenge_bda_contents_parallel(ObjectStartArray * start_arra
           m->push_bdaref_contents(pm, c);
           p += m->size();
         }
-        pm->drain_bda_stacks();
+        pm->drain_bda_stacks(false);
       } else {
         while (p < to) {
           oop m = oop(p);
@@ -836,14 +851,14 @@ CardTableExtension::scavenge_bda_contents_parallel(ObjectStartArray * start_arra
           m->push_bdaref_contents(pm, c);
           p += m->size();
         }
-        pm->drain_bda_stacks();
+        pm->drain_bda_stacks(false);
       }
 
       last_scanned = p;
     }
 
     assert((current_card == following_clean_card) ||
-           (current_card >= end_card),
+           (current_card >= worker_end_card),
            "current_card should only be incremented if it still equals "
            "following_clean_card");
 
@@ -81,7 +81,8 @@ class CardTableExtension : public CardTableModRefBS {
   
   void scavenge_bda_contents_parallel(ObjectStartArray * start_array,
                                       container_t c,
-                                      HeapWord * space_top,
+                                      HeapWord * slice_start,
+                                      HeapWord * slice_end,
                                       PSPromotionManager * pm);
 #endif
   // Verification
@@ -103,6 +104,14 @@ class CardTableExtension : public CardTableModRefBS {
   void inline_write_ref_field_gc(void* field, oop new_val) {
     jbyte* byte = byte_for(field);
     *byte = youngergen_card;
+#ifdef BDA
+    if (bda_summary_base != NULL) {
+      jbyte* entry = bda_summary_for(field);
+      if (*entry == clean_card) {
+        *entry = youngergen_card;
+      }
+    }
+#endif
   }
 
   // Adaptive size policy support
@@ -40,6 +40,9 @@
 #include "runtime/thread.hpp"
 #include "runtime/vmThread.hpp"
 #include "services/management.hpp"
+#ifdef BDA
+#include "bda/bdaPhaseTimes.hpp"
+#endif // BDA
 
 PRAGMA_FORMAT_MUTE_WARNINGS_FOR_GCC
 
@@ -215,19 +218,34 @@ void StealMarkingTask::do_it(GCTaskManager* manager, uint which) {
     ParCompactionManager::gc_thread_compaction_manager(which);
   PSParallelCompact::MarkAndPushClosure mark_and_push_closure(cm);
 
+#ifdef BDA
+  BDAMarkTask mark_task;
+#else
   oop obj = NULL;
+#endif
   ObjArrayTask task;
   int random_seed = 17;
   do {
     while (ParCompactionManager::steal_objarray(which, &random_seed, task)) {
+#ifdef BDA
+      cm->set_bda_owner(task.obj(), task.owner());
+#endif
       ObjArrayKlass* k = (ObjArrayKlass*)task.obj()->klass();
       k->oop_follow_contents(cm, task.obj(), task.index());
       cm->follow_marking_stacks();
     }
+#ifdef BDA
+    while (ParCompactionManager::steal(which, &random_seed, mark_task)) {
+      cm->set_bda_owner(mark_task.obj(), mark_task.owner());
+      mark_task.obj()->follow_contents(cm);
+      cm->follow_marking_stacks();
+    }
+#else
     while (ParCompactionManager::steal(which, &random_seed, obj)) {
       obj->follow_contents(cm);
       cm->follow_marking_stacks();
     }
+#endif
   } while (!terminator()->offer_termination());
 }
 
@@ -296,6 +314,11 @@ void StealRegionCompactionTask::do_it(GCTaskManager* manager, uint which) {
       // Go around again.
     }
   }
+#ifdef BDA
+  if (UseBDA) {
+    cm->report_bda_region_times(which);
+  }
+#endif
   return;
 }
 
@@ -320,6 +343,19 @@ void UpdateDensePrefixTask::do_it(GCTaskManager* manager, uint which) {
                                                          _region_index_end);
 }
 
+#ifdef BDA
+void SummarizeBDASpaceTask::do_it(GCTaskManager* manager, uint which) {
+
+  NOT_PRODUCT(GCTraceTime tm("SummarizeBDASpaceTask",
+    PrintGCDetails && TraceParallelOldGCTasks, true, NULL, PSParallelCompact::gc_tracer()->gc_id()));
+
+  BDAPhaseTimes* phase_times = PSParallelCompact::bda_space()->phase_times();
+  BDAPhaseTimer timer(phase_times, BDAPhaseTimes::SummarizeBDASpace, which);
+  phase_times->add_work_items(BDAPhaseTimes::SummarizeBDASpace, which, 1);
+  PSParallelCompact::summarize_bda_space(_space_id);
+}
+#endif // BDA
+
 void DrainStacksCompactionTask::do_it(GCTaskManager* manager, uint which) {
   assert(Universe::heap()->is_gc_active(), "called outside gc");
 
@@ -355,6 +391,11 @@ void DrainStacksCompactionTask::do_it(GCTaskManager* manager, uint which) {
 
   // Process any regions already in the compaction managers stacks.
   cm->drain_region_stacks();
+#ifdef BDA
+  if (UseBDA) {
+    cm->report_bda_region_times(which);
+  }
+#endif
 
   assert(cm->region_stack()->is_empty(), "Not empty");
 
@@ -235,6 +235,28 @@ class UpdateDensePrefixTask : public GCTask {
   virtual void do_it(GCTaskManager* manager, uint which);
 };
 
+#ifdef BDA
+//
+// SummarizeBDASpaceTask
+//
+// This task summarizes a bda-space into itself. The summaries of
+// different bda-spaces are independent of each other.
+//
+
+class SummarizeBDASpaceTask : public GCTask {
+ private:
+  PSParallelCompact::SpaceId _space_id;
+
+ public:
+  char* name() { return (char *)"summarize-bda-space-task"; }
+
+  SummarizeBDASpaceTask(PSParallelCompact::SpaceId space_id) :
+    _space_id(space_id) {}
+
+  virtual void do_it(GCTaskManager* manager, uint which);
+};
+#endif // BDA
+
 //
 // DrainStacksCompactionTask
 //
@@ -35,6 +35,9 @@
 #include "oops/oop.inline.hpp"
 #include "oops/oop.pcgc.inline.hpp"
 #include "utilities/stack.inline.hpp"
+#ifdef BDA
+#include "bda/bdaPhaseTimes.hpp"
+#endif
 
 PSOldGen*            ParCompactionManager::_old_gen = NULL;
 ParCompactionManager**  ParCompactionManager::_manager_array = NULL;
@@ -62,6 +65,11 @@ ParCompactionManager::ParCompactionManager() :
 
   _old_gen = heap->old_gen();
   _start_array = old_gen()->start_array();
+#ifdef BDA
+  _bda_owner = 0;
+  _bda_region_secs = 0.0;
+  _bda_regions = 0;
+#endif
 
   marking_stack()->initialize();
   _objarray_stack.initialize();
@@ -96,7 +104,7 @@ void ParCompactionManager::initialize(ParMarkBitMap* mbm) {
     region_list(i)->initialize();
   }
 
-  _stack_array = new OopTaskQueueSet(parallel_gc_threads);
+  _stack_array = new MarkingTaskQueueSet(parallel_gc_threads);
   guarantee(_stack_array != NULL, "Could not allocate stack_array");
   _objarray_queues = new ObjArrayTaskQueueSet(parallel_gc_threads);
   guarantee(_objarray_queues != NULL, "Could not allocate objarray_queues");
@@ -177,6 +185,17 @@ ParCompactionManager::gc_thread_compaction_manager(int index) {
 void ParCompactionManager::follow_marking_stacks() {
   do {
     // Drain the overflow stack first, to allow stealing from the marking stack.
+#ifdef BDA
+    BDAMarkTask mark_task;
+    while (marking_stack()->pop_overflow(mark_task)) {
+      set_bda_owner(mark_task.obj(), mark_task.owner());
+      mark_task.obj()->follow_contents(this);
+    }
+    while (marking_stack()->pop_local(mark_task)) {
+      set_bda_owner(mark_task.obj(), mark_task.owner());
+      mark_task.obj()->follow_contents(this);
+    }
+#else
     oop obj;
     while (marking_stack()->pop_overflow(obj)) {
       obj->follow_contents(this);
@@ -184,15 +203,23 @@ void ParCompactionManager::follow_marking_stacks() {
     while (marking_stack()->pop_local(obj)) {
       obj->follow_contents(this);
     }
+#endif
 
     // Process ObjArrays one at a time to avoid marking stack bloat.
     ObjArrayTask task;
     if (_objarray_stack.pop_overflow(task) || _objarray_stack.pop_local(task)) {
+#ifdef BDA
+      set_bda_owner(task.obj(), task.owner());
+#endif
       ObjArrayKlass* k = (ObjArrayKlass*)task.obj()->klass();
       k->oop_follow_contents(this, task.obj(), task.index());
     }
   } while (!marking_stacks_empty());
 
+#ifdef BDA
+  // The roots marked until the next drain have no owner
+  _bda_owner = 0;
+#endif
   assert(marking_stacks_empty(), "Sanity");
 }
 
@@ -209,3 +236,15 @@ void ParCompactionManager::drain_region_stacks() {
     }
   } while (!region_stack()->is_empty());
 }
+
+#ifdef BDA
+void ParCompactionManager::report_bda_region_times(uint worker) {
+  if (_bda_regions > 0) {
+    BDAPhaseTimes* phase_times = PSParallelCompact::bda_space()->phase_times();
+    phase_times->add_time_secs(BDAPhaseTimes::CompactBDARegions, worker, _bda_region_secs);
+    phase_times->add_work_items(BDAPhaseTimes::CompactBDARegions, worker, _bda_regions);
+    _bda_region_secs = 0.0;
+    _bda_regions = 0;
+  }
+}
+#endif
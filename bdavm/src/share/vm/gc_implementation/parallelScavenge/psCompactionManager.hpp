@@ -69,16 +69,24 @@ class ParCompactionManager : public CHeapObj<mtGC> {
   typedef OverflowTaskQueue<ObjArrayTask, mtGC, QUEUE_SIZE> ObjArrayTaskQueue;
   typedef GenericTaskQueueSet<ObjArrayTaskQueue, mtGC>      ObjArrayTaskQueueSet;
   #undef QUEUE_SIZE
+#ifdef BDA
+  // The marking stack keeps the bda-space owner of each object (see _bda_owner)
+  typedef OverflowTaskQueue<BDAMarkTask, mtGC>              MarkingTaskQueue;
+  typedef GenericTaskQueueSet<MarkingTaskQueue, mtGC>       MarkingTaskQueueSet;
+#else
+  typedef OverflowTaskQueue<oop, mtGC>                      MarkingTaskQueue;
+  typedef OopTaskQueueSet                                   MarkingTaskQueueSet;
+#endif
 
   static ParCompactionManager** _manager_array;
-  static OopTaskQueueSet*       _stack_array;
+  static MarkingTaskQueueSet*   _stack_array;
   static ObjArrayTaskQueueSet*  _objarray_queues;
   static ObjectStartArray*      _start_array;
   static RegionTaskQueueSet*    _region_array;
   static PSOldGen*              _old_gen;
 
 private:
-  OverflowTaskQueue<oop, mtGC>        _marking_stack;
+  MarkingTaskQueue              _marking_stack;
   ObjArrayTaskQueue             _objarray_stack;
 
   // Is there a way to reuse the _marking_stack for the
@@ -114,16 +122,28 @@ private:
 
   Action _action;
 
+#ifdef BDA
+  // The bda-space of the object being followed, or 0 if it is not in one. The
+  // objects it marks in the old space are counted for that bda-space, to move them
+  // there at summary (see BDAThreshold). An object outside the bda-spaces takes the
+  // owner of the object that marked it, which is pushed along with it.
+  int _bda_owner;
+  // The time spent filling regions of the bda-spaces and their number, since the
+  // last report to the phase times (see report_bda_region_times).
+  double _bda_region_secs;
+  size_t _bda_regions;
+#endif
+
   static PSOldGen* old_gen()             { return _old_gen; }
   static ObjectStartArray* start_array() { return _start_array; }
-  static OopTaskQueueSet* stack_array()  { return _stack_array; }
+  static MarkingTaskQueueSet* stack_array() { return _stack_array; }
 
   static void initialize(ParMarkBitMap* mbm);
 
  protected:
   // Array of tasks.  Needed by the ParallelTaskTerminator.
   static RegionTaskQueueSet* region_array()      { return _region_array; }
-  OverflowTaskQueue<oop, mtGC>*  marking_stack()       { return &_marking_stack; }
+  MarkingTaskQueue*  marking_stack()       { return &_marking_stack; }
 
   // Pushes onto the marking stack.  If the marking stack is full,
   // pushes onto the overflow stack.
@@ -135,6 +155,19 @@ private:
   Action action() { return _action; }
   void set_action(Action v) { _action = v; }
 
+#ifdef BDA
+  int bda_owner() const { return _bda_owner; }
+  // Sets the owner to follow obj, whose marking object had owner
+  inline void set_bda_owner(oop obj, int owner);
+  void add_bda_region_time(double secs) {
+    _bda_region_secs += secs;
+    _bda_regions++;
+  }
+  // Adds the regions filled so far to the CompactBDARegions phase of worker and
+  // restarts the count.
+  void report_bda_region_times(uint worker);
+#endif
+
   RegionTaskQueue* region_stack()                { return _region_stack; }
   void set_region_stack(RegionTaskQueue* v)       { _region_stack = v; }
 
@@ -170,16 +203,26 @@ private:
   bool should_copy();
 
   // Save for later processing.  Must not fail.
+#ifdef BDA
+  inline void push(oop obj) { _marking_stack.push(BDAMarkTask(obj, _bda_owner)); }
+#else
   inline void push(oop obj) { _marking_stack.push(obj); }
+#endif
   inline void push_objarray(oop objarray, size_t index);
   inline void push_region(size_t index);
 
   // Access function for compaction managers
   static ParCompactionManager* gc_thread_compaction_manager(int index);
 
+#ifdef BDA
+  static bool steal(int queue_num, int* seed, BDAMarkTask& t) {
+    return stack_array()->steal(queue_num, seed, t);
+  }
+#else
   static bool steal(int queue_num, int* seed, oop& t) {
     return stack_array()->steal(queue_num, seed, t);
   }
+#endif
 
   static bool steal_objarray(int queue_num, int* seed, ObjArrayTask& t) {
     return _objarray_queues->steal(queue_num, seed, t);
@@ -32,9 +32,22 @@ void ParCompactionManager::push_objarray(oop obj, size_t index)
 {
   ObjArrayTask task(obj, index);
   assert(task.is_valid(), "bad ObjArrayTask");
+#ifdef BDA
+  task.set_owner(_bda_owner);
+#endif
   _objarray_stack.push(task);
 }
 
+#ifdef BDA
+void ParCompactionManager::set_bda_owner(oop obj, int owner)
+{
+  if (PSParallelCompact::summary_data().bda_counters() != NULL) {
+    const int index = PSParallelCompact::bda_space_index(obj);
+    _bda_owner = index != 0 ? index : owner;
+  }
+}
+#endif
+
 void ParCompactionManager::push_region(size_t index)
 {
 #ifdef ASSERT
@@ -164,6 +164,11 @@ void PSOldGen::initialize_performance_counters(const char* perf_data_name, int l
   _space_counters = new SpaceCounters(perf_data_name, 0,
                                       virtual_space()->reserved_size(),
                                       _object_space, _gen_counters);
+#ifdef BDA
+  if (UseBDA) {
+    bda_space()->initialize_performance_counters();
+  }
+#endif // BDA
 }
 
 // Assume that the generation has been allocated if its
@@ -332,18 +337,28 @@ void PSOldGen::shrink(size_t bytes) {
   assert_locked_or_safepoint(Heap_lock);
 
   size_t size = align_size_down(bytes, virtual_space()->alignment());
+#ifdef BDA
+  if (UseBDA) {
+    // Only the free end of the general object space can be cut. The rest is asked
+    // of the last bda-space at the next full GC.
+    const size_t shrinkable = align_size_down(bda_space()->shrinkable_bytes(),
+                                              virtual_space()->alignment());
+    bda_space()->set_shrink_wanted_bytes(size > shrinkable ? size - shrinkable : 0);
+    size = MIN2(size, shrinkable);
+  }
+#endif // BDA
   if (size > 0) {
     assert_lock_strong(ExpandHeap_lock);
-    virtual_space()->shrink_by(bytes);
+    virtual_space()->shrink_by(size);
     post_resize();
 
     if (Verbose && PrintGC) {
       size_t new_mem_size = virtual_space()->committed_size();
-      size_t old_mem_size = new_mem_size + bytes;
+      size_t old_mem_size = new_mem_size + size;
       gclog_or_tty->print_cr("Shrinking %s from " SIZE_FORMAT "K by "
                                          SIZE_FORMAT "K to "
                                          SIZE_FORMAT "K",
-                      name(), old_mem_size/K, bytes/K, new_mem_size/K);
+                      name(), old_mem_size/K, size/K, new_mem_size/K);
     }
   }
 }
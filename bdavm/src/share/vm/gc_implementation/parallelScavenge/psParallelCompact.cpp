@@ -58,6 +58,9 @@
 #include "services/memTracker.hpp"
 #include "utilities/events.hpp"
 #include "utilities/stack.inline.hpp"
+#ifdef BDA
+#include "bda/bdaPhaseTimes.hpp"
+#endif // BDA
 
 #include <math.h>
 
@@ -112,6 +115,9 @@ ParallelCompactData::RegionData::scanned_bit = 0x1;
 const uint16_t
 ParallelCompactData::RegionData::unscanned_bit = ~scanned_bit;
 
+const uint16_t
+ParallelCompactData::RegionData::moved_bit = 0x2;
+
 unsigned int      PSParallelCompact::bda_last_space_id = 0;
 BDASummaryMap     PSParallelCompact::_summary_map;
 MutableBDASpace * PSParallelCompact::_bda_space = NULL;
@@ -409,6 +415,9 @@ ParallelCompactData::ParallelCompactData()
   _block_vspace = 0;
   _block_data = 0;
   _block_count = 0;
+#ifdef BDA
+  _bda_counters = NULL;
+#endif
 }
 
 bool ParallelCompactData::initialize(MemRegion covered_region)
@@ -426,6 +435,9 @@ bool ParallelCompactData::initialize(MemRegion covered_region)
 #ifdef BDA
   if (UseBDA) {
     result &= initialize_empty_region_data();
+    if (BDAThreshold > 0) {
+      result &= initialize_counter_data();
+    }
   }
 #endif
   return result;
@@ -485,28 +497,23 @@ bool ParallelCompactData::initialize_block_data()
   return false;
 }
 
-#ifdef HEADER_MARK
-// bool
-// ParallelCompactData::initialize_counter_data()
-// {
-//   assert(_region_count != 0 && _block_count != 0, "region and block data must "
-//          "be initialized first");
-//   // const size_t count = _region_count;
-//   const int count = ((MutableBDASpace*)ParallelScavengeHeap::old_gen()->object_space())->spaces()->length();
-//   _bda_counters = new BDADataCounters(count);
-//   _counter_data = _bda_counters->initialize_counter_data(_region_count);
-//   return true;
-// }
-#endif
-
 #ifdef BDA
+bool
+ParallelCompactData::initialize_counter_data()
+{
+  assert(_region_count != 0 && _block_count != 0, "region and block data must "
+         "be initialized first");
+  // One counter per space of the old gen, including the non-bda space
+  const int count = PSParallelCompact::bda_space()->spaces()->length();
+  _bda_counters = new BDADataCounters(_region_count, count);
+  return _bda_counters != NULL;
+}
+
 bool
 ParallelCompactData::initialize_empty_region_data()
 {
   assert(_region_count != 0, "region data must be initialized first");
-  const size_t regions_spanned = MutableBDASpace::CGRPSpace::segment_sz / RegionSize;
-  const size_t count = _region_count / regions_spanned;
-  _empty_region_vspace = create_vspace(count, sizeof(size_t));
+  _empty_region_vspace = create_vspace(empty_region_count(), sizeof(size_t));
   if (_empty_region_vspace != 0) {
     _empty_region_data.initialize(_empty_region_vspace);
     return true;
@@ -532,9 +539,17 @@ void
 ParallelCompactData::clear_empty_region_range()
 {
   assert (_region_count != 0, "was region data initialized?");
-  const size_t regions_spanned = MutableBDASpace::CGRPSpace::segment_sz / RegionSize;
-  const size_t count = _region_count / regions_spanned;
-  _empty_region_data.clear(count);
+  _empty_region_data.clear(empty_region_count());
+}
+
+size_t
+ParallelCompactData::empty_region_count() const
+{
+  // Segments adapt their size, but never go below MinRegionSize. Each bda-space
+  // has its own window of the array, which may need one more entry when the
+  // space is not aligned to MinRegionSize (see summarize_bda_regions).
+  const size_t regions_spanned = MutableBDASpace::MinRegionSize / RegionSize;
+  return _region_count / regions_spanned + KlassRegionMap::number_bdaregions();
 }
 
 void
@@ -785,6 +800,13 @@ bool ParallelCompactData::summarize(SplitInfo& split_info,
 
   HeapWord *dest_addr = target_beg;
   while (cur_region < end_region) {
+#ifdef BDA
+    // A region moved into a bda-space keeps the destination set then.
+    if (_region_data[cur_region].moved()) {
+      ++cur_region;
+      continue;
+    }
+#endif
     // The destination must be set even if the region has no data.
     _region_data[cur_region].set_destination(dest_addr);
 
@@ -864,11 +886,19 @@ bool ParallelCompactData::summarize(SplitInfo& split_info,
 // were already processed. Generally, a segment won't fully compact to a parent container,
 // but a segment may compact to other segments in order to free the segment and return it
 // to the pool.
+// The summary of a space only touches the regions of that space and the segments of its
+// containers, so different spaces may be summarized in parallel (see SummarizeBDASpaceTask).
+// Each one uses its own window of the empty region array, given by space_idx.
+// When defragmenting, the target of a container is a contiguous run large enough for the
+// container and all its segments (see claim_defragment_run), which are then copied in chain
+// order, so that the family ends up in one segment.
 bool
 ParallelCompactData::summarize_bda_regions(SplitInfo& split_info,
                                            HeapWord * source_beg,
                                            HeapWord * source_end,
-                                           HeapWord ** target_next)
+                                           HeapWord ** target_next,
+                                           uint space_idx,
+                                           bool defragment)
 {
   const size_t end_region = addr_to_region_idx(source_end);
   size_t cur_region = addr_to_region_idx (source_beg);
@@ -876,9 +906,11 @@ ParallelCompactData::summarize_bda_regions(SplitInfo& split_info,
   // Initialize the target_next here and update it after
   *target_next = region_to_addr(cur_region);
 
-  // Reset the empty region array, since there cannot be any mix of destination regions
-  // with different bda spaces
-  _empty_region_data.reset();
+  // There cannot be any mix of destination regions with different bda spaces, thus
+  // start with an empty window. It never overlaps the window of the next space.
+  const size_t regions_spanned = MutableBDASpace::MinRegionSize / RegionSize;
+  EmptyRegionData empty_regions;
+  empty_regions.initialize(_empty_region_data.array() + cur_region / regions_spanned + space_idx);
 
   // Now loop through unclaimed regions and process the segment and its children
   while (cur_region < end_region) {
@@ -890,21 +922,29 @@ ParallelCompactData::summarize_bda_regions(SplitInfo& split_info,
       container_t const segment = _region_data[cur_region].container();
       if ((segment->_start == segment->_top) &&
           (addr_to_region_idx(segment->_start) == cur_region)) {
-        _empty_region_data.append(cur_region);
+        empty_regions.append(cur_region);
       }      
       ++cur_region;
       continue;
     }
 
+    // Read the source before a defragment run may install its target over it
+    container_t source_container = _region_data[cur_region].container();
+
     // See if there are empty regions/containers and, if so, set this iteration over
     // the that empty region and subsequent ones belonging to the same container
     size_t target_region;
-    if (_empty_region_data.has_empty_region())
-      target_region = _empty_region_data.remove();
-    else
-      target_region = cur_region;
+    bool source_absorbed = false;
+    const bool defragmenting = defragment &&
+      claim_defragment_run(empty_regions, cur_region, end_region,
+                           &target_region, &source_absorbed);
+    if (!defragmenting) {
+      if (empty_regions.has_empty_region())
+        target_region = empty_regions.remove();
+      else
+        target_region = cur_region;
+    }
     
-    container_t source_container = _region_data[cur_region].container();
     container_t target_container = _region_data[target_region].container();
     const size_t  source_size    = pointer_delta(source_container->_end,
                                                    source_container->_start);
@@ -914,8 +954,8 @@ ParallelCompactData::summarize_bda_regions(SplitInfo& split_info,
           int  target_regions    = addr_to_region_idx(target_container->_hard_end) - target_region;
 
     // Some sources may come from large containers. This may cause the target to overflow,
-    // incurring incorrect behavior.
-    if (source_regions > target_regions) {
+    // incurring incorrect behavior. A defragment run was already sized for the family.
+    if (!defragmenting && source_regions > target_regions) {
       assert (target_region != cur_region, "they must be different.");
       // Compute source size and see if it fits on this target_container.
       size_t source_live = 0;
@@ -926,26 +966,30 @@ ParallelCompactData::summarize_bda_regions(SplitInfo& split_info,
       // Now if source_live is too much for target_size then compact the region onto itself
       // and return the target_region to the empty
       if (source_live > target_size) {
-        if (_empty_region_data.has_empty_region(source_regions - target_regions)) {
+        if (empty_regions.has_empty_region(source_regions - target_regions)) {
           // Attempt to grab a handful of regions from the _empty_region_array and compact there.
           int reg_req = target_regions;
           size_t middle_region_idx;
-          RegionData middle_region;
+          container_t middle;
+          HeapWord * hard_end;
+          HeapWord * end;
           do {
-            middle_region_idx = _empty_region_data.remove();
-            middle_region = _region_data[middle_region_idx];
-            reg_req += addr_to_region_idx (middle_region.container()->_hard_end) -
-              middle_region_idx;
-            assert (middle_region.container()->_start == middle_region.container()->_top,
-                    "should not be possible");
+            middle_region_idx = empty_regions.remove();
+            middle = _region_data[middle_region_idx].container();
+            reg_req += addr_to_region_idx (middle->_hard_end) - middle_region_idx;
+            assert (middle->_start == middle->_top, "should not be possible");
+            hard_end = middle->_hard_end; end = middle->_end;
+            // The middle segment is now part of the target. Its descriptor goes back
+            // to the pool, or it would stay in the containers of its space.
+            PSParallelCompact::bda_space()->add_to_pool(middle, (uint)middle->_space_id);
           } while (reg_req < source_regions);
 
           // Setup target_container to be a large one and install it in the regions.
-          target_container->_hard_end = middle_region.container()->_hard_end;
-          target_container->_end = middle_region.container()->_end;
+          target_container->_hard_end = hard_end;
+          target_container->_end = end;
           install_bda_container(target_container);
         } else {
-          _empty_region_data.return_to_array(target_region);
+          empty_regions.return_to_array(target_region);
           // Do not update this before the prior call!
           // Update all to avoid confusion.
           target_region = cur_region;
@@ -955,7 +999,7 @@ ParallelCompactData::summarize_bda_regions(SplitInfo& split_info,
         target_regions = addr_to_region_idx(target_container->_hard_end) - target_region;
       }
     }
-      
+
     // Summarization of the spaces is here.
     //
     // The algorithm goes by first getting the source_live words and setting the regions
@@ -1072,6 +1116,15 @@ ParallelCompactData::summarize_bda_regions(SplitInfo& split_info,
       container_seg = container_seg->_next_segment;
     }
 
+#ifdef ASSERT
+    if (defragmenting) {
+      for (container_t seg = source_container->_next_segment; seg != NULL; seg = seg->_next_segment) {
+        assert (PSParallelCompact::bda_space()->non_bda_space()->contains(seg->_start),
+                "a defragmented family must end up in one segment");
+      }
+    }
+#endif
+
     // The container claimed all segments it could. Thus dest_addr is now this container's
     // top pointer. This top pointer can be changed if other segments claim this, maintaining
     // the invariant that in the end of the summary phase, all top pointers of all segments are
@@ -1081,14 +1134,17 @@ ParallelCompactData::summarize_bda_regions(SplitInfo& split_info,
     // Was anything promoted to this container? If not then add it to the empty array
     if (pointer_delta(target_container->_top, target_container->_start) == 0) {
       if (target_region != cur_region) {
-        _empty_region_data.return_to_array(target_region);
+        empty_regions.return_to_array(target_region);
       }
-      _empty_region_data.append(cur_region);
+      empty_regions.append(cur_region);
     } else if (target_region != cur_region) {
       // append the source in case it was depleted
       assert (target_region < cur_region, "should be a previous region.");
       source_container->_top = source_container->_start;
-      _empty_region_data.append(cur_region);
+      // An absorbed source is part of the target now, it is not empty
+      if (!source_absorbed) {
+        empty_regions.append(cur_region);
+      }
     }
 
     // Fix the links between segments
@@ -1099,6 +1155,14 @@ ParallelCompactData::summarize_bda_regions(SplitInfo& split_info,
         target_container->_next_segment->_prev_segment = target_container;
       if (target_container->_prev_segment != NULL)
         target_container->_prev_segment->_next_segment = target_container;
+      // The target took over the links, so the descriptor of an absorbed source can go
+      if (source_absorbed) {
+        PSParallelCompact::bda_space()->add_to_pool(source_container,
+                                                    (uint)source_container->_space_id);
+      } else {
+        source_container->_next_segment = NULL;
+        source_container->_prev_segment = NULL;
+      }
     }
     
     // dest_addr grows during scanning and summarizing, but is only valid per iteration,
@@ -1123,6 +1187,151 @@ ParallelCompactData::summarize_bda_regions(SplitInfo& split_info,
   return true;
 }
 
+// Finds the target of a container that is to be defragmented: a contiguous run of empty
+// segments, which may include the container itself, large enough for the live data of the
+// container and of all its segments. It first looks for a run among the empty segments
+// before cur_region, the first one that fits. Otherwise the run is built around the container,
+// with the empty segments right before it (the last ones in the array) and, if still short,
+// with the empty segments right after it that were not summarized yet. The run never reaches
+// past a segment of the family, so no data moves up in the heap. The segments of the run,
+// except the first one, go back to the pool and the first one becomes the target.
+// Returns false, and changes nothing, if the container has no segments to join or no such
+// run exists. If the container itself was absorbed by a target before it, source_absorbed is
+// set and its descriptor must go to the pool once the target takes over its links.
+bool
+ParallelCompactData::claim_defragment_run(EmptyRegionData& empty_regions,
+                                          size_t cur_region,
+                                          size_t end_region,
+                                          size_t* target_region,
+                                          bool* source_absorbed)
+{
+  MutableBDASpace * const bda_space = PSParallelCompact::bda_space();
+  container_t const source = _region_data[cur_region].container();
+  if (source->_prev_segment != NULL || source->_next_segment == NULL) return false;
+
+  // Sum the live data of the container and of its segments. A segment that was already
+  // summarized cannot be moved anymore, so the family cannot be joined.
+  size_t family_live = 0;
+  const size_t source_end = addr_to_region_idx(source->_hard_end);
+  for (size_t r = cur_region; r < source_end; ++r) {
+    family_live += _region_data[r].data_size();
+  }
+  bool has_segments = false;
+  for (container_t seg = source->_next_segment; seg != NULL; seg = seg->_next_segment) {
+    if (bda_space->non_bda_space()->contains(seg->_start)) continue;
+    const size_t seg_end = addr_to_region_idx(seg->_hard_end);
+    for (size_t r = addr_to_region_idx(seg->_start); r < seg_end; ++r) {
+      if (_region_data[r].scanned()) return false;
+      family_live += _region_data[r].data_size();
+    }
+    has_segments = true;
+  }
+  if (!has_segments || family_live == 0) return false;
+
+  // A run of empty segments before the container, in heap order in the array.
+  size_t run_first = empty_regions.first();
+  for (size_t i = empty_regions.first(); i < empty_regions.last(); ++i) {
+    container_t const c = _region_data[empty_regions.at(i)].container();
+    const bool joinable = c->_prev_segment == NULL && c->_next_segment == NULL;
+    if (!joinable) {
+      run_first = i + 1;
+      continue;
+    }
+    if (i > run_first &&
+        addr_to_region_idx(_region_data[empty_regions.at(i - 1)].container()->_hard_end) !=
+        empty_regions.at(i)) {
+      run_first = i;
+    }
+    // Leave out the segments at the start of the run that are not needed
+    while (run_first < i &&
+           pointer_delta(c->_end, _region_data[empty_regions.at(run_first + 1)].container()->_start)
+             >= family_live) {
+      ++run_first;
+    }
+    container_t const first = _region_data[empty_regions.at(run_first)].container();
+    if (pointer_delta(c->_end, first->_start) >= family_live) {
+      // c goes to the pool with the others, so save its ends first
+      HeapWord * const hard_end = c->_hard_end;
+      HeapWord * const end = c->_end;
+      for (size_t j = run_first + 1; j <= i; ++j) {
+        container_t const middle = _region_data[empty_regions.at(j)].container();
+        assert (middle->_start == middle->_top, "should not be possible");
+        bda_space->add_to_pool(middle, (uint)middle->_space_id);
+      }
+      first->_hard_end = hard_end;
+      first->_end = end;
+      install_bda_container(first);
+      *target_region = empty_regions.at(run_first);
+      empty_regions.remove_run(run_first, i - run_first + 1);
+      return true;
+    }
+  }
+
+  // A run around the container. First the empty segments that end where it starts.
+  HeapWord * run_start = source->_start;
+  HeapWord * run_end = source->_end;
+  HeapWord * run_hard_end = source->_hard_end;
+  size_t before = 0;
+  while (pointer_delta(run_end, run_start) < family_live &&
+         empty_regions.first() + before < empty_regions.last()) {
+    container_t const c =
+      _region_data[empty_regions.at(empty_regions.last() - before - 1)].container();
+    if (c->_hard_end != run_start || c->_prev_segment != NULL || c->_next_segment != NULL) break;
+    run_start = c->_start;
+    ++before;
+  }
+  // Then the empty segments that follow it and were not summarized yet.
+  size_t after = 0;
+  while (pointer_delta(run_end, run_start) < family_live) {
+    const size_t r = addr_to_region_idx(run_hard_end);
+    if (r >= end_region || _region_data[r].scanned()) break;
+    container_t const c = _region_data[r].container();
+    if (c == NULL || c->_start != run_hard_end ||
+        c->_prev_segment != NULL || c->_next_segment != NULL) break;
+    bool empty = true;
+    const size_t c_end = addr_to_region_idx(c->_hard_end);
+    for (size_t cr = r; cr < c_end && empty; ++cr) {
+      empty = _region_data[cr].data_size() == 0;
+    }
+    if (!empty) break;
+    run_end = c->_end;
+    run_hard_end = c->_hard_end;
+    ++after;
+  }
+  if (pointer_delta(run_end, run_start) < family_live) return false;
+
+  container_t const target = before > 0 ?
+    _region_data[empty_regions.at(empty_regions.last() - before)].container() : source;
+  for (size_t k = before; k > 1; --k) {
+    container_t const middle =
+      _region_data[empty_regions.at(empty_regions.last() - k + 1)].container();
+    assert (middle->_start == middle->_top, "should not be possible");
+    bda_space->add_to_pool(middle, (uint)middle->_space_id);
+  }
+  // The segments after the container have no live data, so they compact onto themselves.
+  HeapWord * next = source->_hard_end;
+  for (size_t k = 0; k < after; ++k) {
+    container_t const c = _region_data[addr_to_region_idx(next)].container();
+    next = c->_hard_end;
+    const size_t c_end = addr_to_region_idx(c->_hard_end);
+    for (size_t r = addr_to_region_idx(c->_start); r < c_end; ++r) {
+      _region_data[r].set_destination(region_to_addr(r));
+      _region_data[r].set_destination_count(0);
+      _region_data[r].set_scanned();
+    }
+    c->_top = c->_start;
+    bda_space->add_to_pool(c, (uint)c->_space_id);
+  }
+  empty_regions.remove_last(before);
+
+  target->_end = run_end;
+  target->_hard_end = run_hard_end;
+  install_bda_container(target);
+  *target_region = addr_to_region_idx(target->_start);
+  *source_absorbed = target != source;
+  return true;
+}
+
 bool
 ParallelCompactData::fraction_of_occupancy(size_t live_data, size_t total_size)
 {
@@ -1321,9 +1530,9 @@ void PSParallelCompact::initialize_space_info()
   // redefine old_space_id space
   _space_info[old_space_id].set_space(_bda_space->spaces()->at(0)->space());
   for(int idx = 1; idx <= nbda; ++idx) {
-    _space_info[to_space_id + idx].set_space(
+    _space_info[bda_space_info_id(idx)].set_space(
       _bda_space->spaces()->at(idx)->space());
-    _space_info[to_space_id + idx].set_start_array(heap->old_gen()->start_array());
+    _space_info[bda_space_info_id(idx)].set_start_array(heap->old_gen()->start_array());
   }
   // A hacky way to avoid serious change of code on for loops since they rely on this
   // value to stop
@@ -1390,9 +1599,11 @@ PSParallelCompact::clear_data_covering_space(SpaceId id)
 #ifdef BDA
   if (UseBDA) {
     if (id >= last_space_id) {
+      BDASerialPhaseTimer tm(_bda_space->phase_times(), BDAPhaseTimes::PostCompact,
+                             false, false, NULL, _gc_tracer.gc_id());
       // This specialized version also returns empty containers to the pool
       MutableBDASpace::CGRPSpace * space_manager =
-        _bda_space->spaces()->at((uint)(id -last_space_id) + 1);
+        _bda_space->spaces()->at(bda_space_of(id));
       _summary_data.clear_bda_range(beg_region, end_region, space_manager);
       _summary_data.clear_empty_region_range();
       gclog_or_tty->print_cr("Verifying other gen refs from bda space with old gen id = "
@@ -1403,6 +1614,9 @@ PSParallelCompact::clear_data_covering_space(SpaceId id)
     } else if (id == old_space_id) {
       _bda_space->clear_delete_containers_in_space((uint)old_space_id);
       _summary_data.clear_range(beg_region, end_region);
+      if (_summary_data.bda_counters() != NULL) {
+        _summary_data.bda_counters()->clear_range(beg_region, end_region);
+      }
     }
   } else
 #endif
@@ -1525,6 +1739,12 @@ void PSParallelCompact::post_compact()
     heap->gen_mangle_unused_area();
   }
 
+#ifdef BDA
+  _bda_space->reset_reserved_words();
+  _bda_space->recompute_fragmentation_stats();
+  _bda_space->update_counters();
+#endif // BDA
+
   // Update time of last GC
   reset_millis_since_last_gc();
 }
@@ -2113,6 +2333,98 @@ PSParallelCompact::provoke_split(bool & max_compaction)
 }
 #endif // #ifndef PRODUCT
 
+#ifdef BDA
+void PSParallelCompact::summarize_bda_space(SpaceId id)
+{
+  assert (id >= last_space_id && id < bda_last_space_id, "not a bda-space");
+  const MutableSpace * space = _space_info[id].space();
+  HeapWord ** nta = _space_info[id].new_top_addr();
+  const uint space_idx = id - last_space_id;
+  const bool defragment = _bda_space->spaces()->at(bda_space_of(id))->should_defragment();
+  bool result = _summary_data.summarize_bda_regions(_space_info[id].split_info(),
+                                                    space->bottom(),
+                                                    space->top(),
+                                                    nta,
+                                                    space_idx,
+                                                    defragment);
+  assert (result, "space must fit into itself");
+  _space_info[id].set_dense_prefix(space->bottom());
+}
+
+// The regions of the old space whose live objects were mostly reached, during marking,
+// from the containers of a single bda-space are moved into that space, so that element
+// objects left in the old space end up with their containers. A region is only moved
+// as a whole, to the start of a new container of its own, from which the region is the
+// only source. Thus it must not hold part of an object crossing its boundaries and it
+// must be past the dense prefix, whose objects do not move. The remainder of the old
+// space is then summarized again without the moved regions.
+void PSParallelCompact::summarize_stray_regions()
+{
+  BDADataCounters * const counters = _summary_data.bda_counters();
+  if (counters == NULL) {
+    return;
+  }
+
+  const MutableSpace * const space = _space_info[old_space_id].space();
+  HeapWord * const dense_prefix_end = _space_info[old_space_id].dense_prefix();
+  const size_t beg_region = _summary_data.addr_to_region_idx(dense_prefix_end);
+  const size_t end_region =
+    _summary_data.addr_to_region_idx(_summary_data.region_align_up(space->top()));
+  const size_t max_words = MutableBDASpace::MinRegionSize - MutableBDASpace::_filler_header_size;
+
+  size_t moved = 0;
+  for (size_t cur_region = beg_region; cur_region < end_region; ++cur_region) {
+    RegionData * const region_ptr = _summary_data.region(cur_region);
+    const size_t words = region_ptr->data_size();
+    if (words == 0 || words > max_words || region_ptr->partial_obj_size() != 0) {
+      continue;
+    }
+    if (cur_region + 1 < end_region &&
+        _summary_data.region(cur_region + 1)->partial_obj_size() != 0) {
+      continue;
+    }
+
+    jint count, total;
+    const int id = counters->most_counts_id(cur_region, &count, &total);
+    if (id == 0 || (uintx)count * 100 < BDAThreshold * (uintx)total) {
+      continue;
+    }
+
+    MutableBDASpace::CGRPSpace * const grp = _bda_space->spaces()->at(id);
+    container_t const container = grp->push_region_container(words);
+    if (container == NULL) {
+      // The bda-space is full; the region stays in the old space
+      continue;
+    }
+
+    region_ptr->set_destination(container->_start);
+    region_ptr->set_destination_count(1);
+    region_ptr->set_data_location(_summary_data.region_to_addr(cur_region));
+    region_ptr->set_moved();
+    _summary_data.addr_to_region_ptr(container->_start)->set_source_region(cur_region);
+
+    SpaceInfo * const info = &_space_info[bda_space_info_id(id)];
+    if (info->new_top() < container->_hard_end) {
+      info->set_new_top(container->_hard_end);
+    }
+    ++moved;
+  }
+
+  if (moved > 0) {
+    clear_source_region(dense_prefix_end, space->top());
+    bool result = _summary_data.summarize(_space_info[old_space_id].split_info(),
+                                          dense_prefix_end, space->top(), NULL,
+                                          dense_prefix_end, space->end(),
+                                          _space_info[old_space_id].new_top_addr());
+    assert (result, "space must fit into itself");
+  }
+  if (BDAllocationVerboseLevel > 0) {
+    gclog_or_tty->print_cr("[BDA: moved " SIZE_FORMAT " old regions into the bda-spaces]",
+                           moved);
+  }
+}
+#endif
+
 void PSParallelCompact::summarize_spaces_quick()
 {
   for (unsigned int i = 0; i < last_space_id; ++i)
@@ -2126,16 +2438,34 @@ void PSParallelCompact::summarize_spaces_quick()
     _space_info[i].set_dense_prefix(space->bottom());
   }
 #ifdef BDA
-  for (unsigned int i = last_space_id; i < bda_last_space_id; ++i)
   {
-    const MutableSpace * space = _space_info[i].space();
-    HeapWord ** nta = _space_info[i].new_top_addr();
-    bool result = _summary_data.summarize_bda_regions(_space_info[i].split_info(),
-                                                      space->bottom(),
-                                                      space->top(),
-                                                      nta);
-    assert (result, "space must fit into itself");
-    _space_info[i].set_dense_prefix(space->bottom());
+    BDASerialPhaseTimer tm_bda(_bda_space->phase_times(), BDAPhaseTimes::Summary,
+                               print_phases(), true, &_gc_timer, _gc_tracer.gc_id());
+    const uint bda_spaces = bda_last_space_id - last_space_id;
+    if (ParallelGCThreads > 1 && bda_spaces > 1) {
+      // Enqueue the largest spaces first, so that the longest summaries start
+      // right away and do not end up alone at the end.
+      ResourceMark rm;
+      SpaceId * const ids = NEW_RESOURCE_ARRAY(SpaceId, bda_spaces);
+      for (uint i = 0; i < bda_spaces; ++i) {
+        SpaceId id = SpaceId(last_space_id + i);
+        const size_t used = _space_info[id].space()->used_in_words();
+        uint j = i;
+        for (; j > 0 && _space_info[ids[j - 1]].space()->used_in_words() < used; --j) {
+          ids[j] = ids[j - 1];
+        }
+        ids[j] = id;
+      }
+      GCTaskQueue* q = GCTaskQueue::create();
+      for (uint i = 0; i < bda_spaces; ++i) {
+        q->enqueue(new SummarizeBDASpaceTask(ids[i]));
+      }
+      gc_task_manager()->execute_and_wait(q);
+    } else {
+      for (unsigned int i = last_space_id; i < bda_last_space_id; ++i) {
+        summarize_bda_space(SpaceId(i));
+      }
+    }
   }
 #endif
 
@@ -2370,6 +2700,9 @@ void PSParallelCompact::summary_phase(ParCompactionManager* cm,
 
   // Old generations.
   summarize_space(old_space_id, maximum_compaction);
+#ifdef BDA
+  summarize_stray_regions();
+#endif
 // #ifdef BDA
 //   for (unsigned int id = last_space_id; id < bda_last_space_id; ++id) {
 //     summarize_space(SpaceId(id), maximum_compaction);    
@@ -2561,8 +2894,17 @@ bool PSParallelCompact::invoke_no_policy(bool maximum_heap_compaction) {
   }
 
 #ifdef BDA
-  if (ContainerFragmentationAtFullGC || ContainerFragmentationAtGC) {
-    _bda_space->print_spaces_fragmentation_stats();
+  _bda_space->phase_times()->note_gc_start(true);
+  {
+    BDASerialPhaseTimer tm(_bda_space->phase_times(), BDAPhaseTimes::Prepare,
+                           false, false, &_gc_timer, _gc_tracer.gc_id());
+    // The summary needs every slot below the top of a bda-space in a segment
+    _bda_space->retire_segment_caches();
+    _bda_space->retire_spills();
+    if (ContainerFragmentationAtFullGC || ContainerFragmentationAtGC) {
+      _bda_space->print_spaces_fragmentation_stats();
+    }
+    _bda_space->select_spaces_to_defragment();
   }
 #ifdef BDA_PARANOID
   bda_space()->verify_segments_in_othergen();
@@ -2622,6 +2964,15 @@ bool PSParallelCompact::invoke_no_policy(bool maximum_heap_compaction) {
     marking_start.update();
     marking_phase(vmthread_cm, maximum_heap_compaction, &_gc_tracer);
 
+#ifdef BDA
+    {
+      // Make room for the old gen to shrink as much as the last resize wanted
+      BDASerialPhaseTimer tm(_bda_space->phase_times(), BDAPhaseTimes::Prepare,
+                             false, false, NULL, _gc_tracer.gc_id());
+      _bda_space->prepare_shrink();
+    }
+#endif // BDA
+
     bool max_on_system_gc = UseMaximumCompactionOnSystemGC
       && gc_cause == GCCause::_java_lang_system_gc;
     summary_phase(vmthread_cm, maximum_heap_compaction || max_on_system_gc);
@@ -2777,6 +3128,13 @@ bool PSParallelCompact::invoke_no_policy(bool maximum_heap_compaction) {
 
   NOT_PRODUCT(ref_processor()->verify_no_references_recorded());
 
+#ifdef BDA
+  if (PrintGCDetails) {
+    _bda_space->phase_times()->print();
+  }
+  _bda_space->phase_times()->report(&_gc_tracer);
+#endif // BDA
+
   collection_exit.update();
 
   heap->print_heap_after_gc();
@@ -3644,7 +4002,14 @@ size_t PSParallelCompact::next_src_region(MoveAndUpdateClosure& closure,
     }
   } else
 #endif
-    while (src_region_ptr < top_region_ptr && src_region_ptr->data_size() == 0) {
+    // The regions moved into a bda-space are not copied within the old space
+    while (src_region_ptr < top_region_ptr &&
+#ifdef BDA
+           (src_region_ptr->data_size() == 0 || src_region_ptr->moved())
+#else
+           src_region_ptr->data_size() == 0
+#endif
+           ) {
       ++src_region_ptr;
     }
 
@@ -3714,6 +4079,15 @@ size_t PSParallelCompact::next_src_region(MoveAndUpdateClosure& closure,
   return 0;
 }
 
+#ifdef BDA
+void PSParallelCompact::fill_bda_region(ParCompactionManager* cm, size_t region)
+{
+  const double start = os::elapsedTime();
+  fill_region(cm, region);
+  cm->add_bda_region_time(os::elapsedTime() - start);
+}
+#endif // BDA
+
 void PSParallelCompact::fill_region(ParCompactionManager* cm, size_t region_idx)
 {
   typedef ParMarkBitMap::IterationStatus IterationStatus;
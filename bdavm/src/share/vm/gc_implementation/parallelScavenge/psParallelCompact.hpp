@@ -235,10 +235,6 @@ public:
   static const size_t BlocksPerRegion;
   static const size_t Log2BlocksPerRegion;
 
-#ifdef BDA
-  typedef BDADataCounters::CounterData CounterData;
-#endif
-  
   class RegionData
   {
   public:
@@ -254,6 +250,9 @@ public:
 
     // Returns true if region was already scanned during summary.
     bool          scanned()   const { return (_scanned & scanned_bit) != 0; }
+    // Returns true if the region of the old space was moved into a bda-space
+    // during summary (see PSParallelCompact::summarize_stray_regions).
+    bool          moved()     const { return (_scanned & moved_bit) != 0; }
     // </dpatricio>
 
     // The object (if any) starting in this region and ending in a different
@@ -335,6 +334,7 @@ public:
     // Sets the bit of the region to indicate it has been processed during summary.
     // No need to MT, but if summary becomes MT then this must be atomic.
     void set_scanned() { _scanned = scanned_bit; }
+    void set_moved()   { _scanned |= moved_bit; }
     // </dpatricio>
 
     inline void set_blocks_filled();
@@ -377,9 +377,11 @@ public:
     // to the container.
     container_t          _container;
     uint16_t             _scanned;
-    // These bits indicate if the region has been scanned during summary
+    // These bits indicate if the region has been scanned during summary, or
+    // moved into a bda-space
     static const uint16_t scanned_bit;
     static const uint16_t unscanned_bit;
+    static const uint16_t moved_bit;
     // </dpatricio>
 
 #ifdef ASSERT
@@ -421,10 +423,22 @@ public:
   {
    public:
     void          initialize(PSVirtualSpace * vspace);
+    // Uses the part of another array that starts at array
+    void          initialize(size_t * array) {
+      _empty_region_array = array;
+      _empty_region_idx = 0; _next_append = 0;
+    }
+    size_t *      array() const { return _empty_region_array; }
     void          clear(size_t cnt);
     inline void   append(size_t region);
     inline void   return_to_array(size_t region);
     inline size_t remove();
+    // The claimable entries are at(first()) ... at(last() - 1), in heap order
+    size_t        first() const { return _empty_region_idx; }
+    size_t        last() const { return _next_append; }
+    size_t        at(size_t i) const { return _empty_region_array[i]; }
+    inline void   remove_run(size_t i, size_t n);
+    inline void   remove_last(size_t n);
     inline bool   has_empty_region();
     inline bool   has_empty_region(uint n);
     inline void   reset();
@@ -471,7 +485,8 @@ public:
   // <dpatricio>
   bool summarize_bda_regions(SplitInfo& split_info,
                              HeapWord* source_beg, HeapWord* source_end,
-                             HeapWord** source_next);
+                             HeapWord** source_next, uint space_idx,
+                             bool defragment);
   bool fraction_of_occupancy(size_t live_data, size_t total_size);
   void clear_bda_range(size_t beg_region, size_t end_region, MutableBDASpace::CGRPSpace * sp);
   void clear_bda_range(HeapWord * beg, HeapWord * end, MutableBDASpace::CGRPSpace * sp) {
@@ -479,6 +494,11 @@ public:
   }
   void clear_empty_region_range();
   inline void install_bda_container(container_t container);
+  bool claim_defragment_run(EmptyRegionData& empty_regions, size_t cur_region,
+                            size_t end_region, size_t* target_region,
+                            bool* source_absorbed);
+  // The ownership counts of the regions, or NULL if BDAThreshold is 0.
+  BDADataCounters * bda_counters() const { return _bda_counters; }
   // </dpatricio>
   
   void clear();
@@ -536,7 +556,9 @@ private:
   bool initialize_region_data(size_t region_size);
 #ifdef BDA
   bool initialize_empty_region_data();
-  // bool initialize_counter_data();
+  // the number of entries of the empty region array
+  size_t empty_region_count() const;
+  bool initialize_counter_data();
 #endif
   PSVirtualSpace* create_vspace(size_t count, size_t element_size);
 
@@ -561,7 +583,6 @@ private:
   
   MutableBDASpace * _old_space;
   BDADataCounters * _bda_counters;
-  CounterData *     _counter_data;
 #endif
 };
 
@@ -698,6 +719,25 @@ ParallelCompactData::EmptyRegionData::remove()
   return _empty_region_array[_empty_region_idx++];
 }
 
+// Removes the n entries starting at i, shifting the ones before them so that the
+// remaining entries stay in heap order.
+inline void
+ParallelCompactData::EmptyRegionData::remove_run(size_t i, size_t n)
+{
+  assert (_empty_region_idx <= i && i + n <= _next_append, "run out of the array");
+  for (size_t j = i; j > _empty_region_idx; --j) {
+    _empty_region_array[j + n - 1] = _empty_region_array[j - 1];
+  }
+  _empty_region_idx += n;
+}
+
+inline void
+ParallelCompactData::EmptyRegionData::remove_last(size_t n)
+{
+  assert (_empty_region_idx + n <= _next_append, "removing more than appended");
+  _next_append -= n;
+}
+
 inline bool
 ParallelCompactData::EmptyRegionData::has_empty_region()
 {
@@ -1111,6 +1151,9 @@ class PSParallelCompact : AllStatic {
   friend class FollowKlassClosure;
   friend class InstanceClassLoaderKlass;
   friend class RefProcTaskProxy;
+#ifdef BDA
+  friend class SummarizeBDASpaceTask;
+#endif
 
  private:
   static STWGCTimer           _gc_timer;
@@ -1159,6 +1202,16 @@ class PSParallelCompact : AllStatic {
   // the number of bda_regions (which is the number of regions in old gen minus 1
   static unsigned int         bda_last_space_id;
   // </dpatricio>
+
+  // The bda-spaces follow the spaces of the young gen in _space_info, in the order of
+  // their space ids in MutableBDASpace::spaces(), from 1 (see BDARegion).
+  static SpaceId bda_space_info_id(int idx) {
+    return SpaceId(last_space_id + idx - 1);
+  }
+  static int     bda_space_of(SpaceId id) {
+    assert(id >= last_space_id && id < bda_last_space_id, "not a bda-space");
+    return id - last_space_id + 1;
+  }
   
  private:
 
@@ -1259,6 +1312,13 @@ class PSParallelCompact : AllStatic {
 #endif
 
   static void summarize_spaces_quick();
+#ifdef BDA
+  // Summarizes a bda-space into itself. Called by the SummarizeBDASpaceTask.
+  static void summarize_bda_space(SpaceId id);
+  // Moves the regions of the old space whose objects were mostly reached from the
+  // containers of one bda-space into new segments of that space (see BDAThreshold).
+  static void summarize_stray_regions();
+#endif
   static void summarize_space(SpaceId id, bool maximum_compaction);
   static void summary_phase(ParCompactionManager* cm, bool maximum_compaction);
 
@@ -1427,8 +1487,19 @@ class PSParallelCompact : AllStatic {
   // Fill a region, copying objects from one or more source regions.
   static void fill_region(ParCompactionManager* cm, size_t region_idx);
   static void fill_and_update_region(ParCompactionManager* cm, size_t region) {
+#ifdef BDA
+    if (UseBDA && is_bda_region(region)) {
+      fill_bda_region(cm, region);
+      return;
+    }
+#endif
     fill_region(cm, region);
   }
+#ifdef BDA
+  // Fills a region of a bda-space and adds the time it took to the compaction
+  // manager, which reports it in the CompactBDARegions phase.
+  static void fill_bda_region(ParCompactionManager* cm, size_t region);
+#endif
 
   // <dpatricio>
   // Install the container_t ptr in the RegionData that manages the container address range
@@ -1443,6 +1514,16 @@ class PSParallelCompact : AllStatic {
   inline static bool is_same_container(size_t src_region_idx, size_t region_idx);
   // Getter for the convenience bda_space ptr
   static MutableBDASpace* bda_space() { return _bda_space; }
+#ifdef BDA
+  // The index of the bda-space that holds obj in the spaces of _bda_space, or 0 if
+  // obj is not in a bda-space.
+  static inline int bda_space_index(oop obj);
+  // Is the region at region_idx within a bda-space?
+  static inline bool is_bda_region(size_t region_idx);
+  // Counts obj, just marked by a thread following an object of the bda-space owner
+  // (0 if none), in the ownership counts of its region.
+  static inline void count_bda_owner(oop obj, int owner);
+#endif
   
   // Fill in the block table for the specified region.
   static void fill_blocks(size_t region_idx);
@@ -1512,6 +1593,13 @@ inline void PSParallelCompact::follow_root(ParCompactionManager* cm, T* p) {
     oop obj = oopDesc::decode_heap_oop_not_null(heap_oop);
     if (mark_bitmap()->is_unmarked(obj)) {
       if (mark_obj(obj)) {
+#ifdef BDA
+        // A root has no owner, but a root in a bda-space owns what it reaches
+        if (_summary_data.bda_counters() != NULL) {
+          count_bda_owner(obj, 0);
+          cm->set_bda_owner(obj, 0);
+        }
+#endif
         obj->follow_contents(cm);
       }
     }
@@ -1525,6 +1613,13 @@ inline void PSParallelCompact::mark_and_push(ParCompactionManager* cm, T* p) {
   if (!oopDesc::is_null(heap_oop)) {
     oop obj = oopDesc::decode_heap_oop_not_null(heap_oop);
     if (mark_bitmap()->is_unmarked(obj) && mark_obj(obj)) {
+#ifdef BDA
+      // Count every marked object, so that the counts of a region add up to
+      // its live objects and the owner of a region is a true majority.
+      if (_summary_data.bda_counters() != NULL) {
+        count_bda_owner(obj, cm->bda_owner());
+      }
+#endif
       cm->push(obj);
     }
   }
@@ -1656,6 +1751,36 @@ PSParallelCompact::is_same_container(size_t src_region_idx, size_t region_idx)
   container_t c2 = summary_data().region(region_idx)->container();
   return  c1 == c2;
 }
+#ifdef BDA
+inline int
+PSParallelCompact::bda_space_index(oop obj)
+{
+  HeapWord * const p = (HeapWord*)obj;
+  // The manager spans the whole old gen, i.e., the non-bda space and the bda-spaces
+  if (p < _bda_space->bottom() || p >= _bda_space->end() ||
+      _bda_space->non_bda_space()->contains(p)) {
+    return 0;
+  }
+  // Live objects are always within a segment, whose descriptor is installed in
+  // the regions it spans.
+  return (int)get_container_at_addr(p)->_space_id;
+}
+inline bool
+PSParallelCompact::is_bda_region(size_t region_idx)
+{
+  HeapWord * const p = _summary_data.region_to_addr(region_idx);
+  return p >= _bda_space->bottom() && p < _bda_space->end() &&
+    !_bda_space->non_bda_space()->contains(p);
+}
+inline void
+PSParallelCompact::count_bda_owner(oop obj, int owner)
+{
+  if (_bda_space->non_bda_space()->contains(obj)) {
+    BDADataCounters * const counters = _summary_data.bda_counters();
+    counters->incr_counter(_summary_data.addr_to_region_idx((HeapWord*)obj), owner);
+  }
+}
+#endif
 
 #ifdef ASSERT
 inline void
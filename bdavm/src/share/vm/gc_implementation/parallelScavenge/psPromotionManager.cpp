@@ -74,6 +74,11 @@ void PSPromotionManager::initialize() {
     for (uint i = 0; i < ParallelGCThreads; i++) {
       bda_stack_array()->register_queue(i, _manager_array[i].bdaref_stack());
     }
+    // The VMThread's manager uses the last segment cache of each bda-space
+    for (uint i = 0; i < ParallelGCThreads + 1; i++) {
+      _manager_array[i]._worker_id = i;
+      _manager_array[i]._bda_old_labs.set_worker_id(i);
+    }
   }
 #endif
 
@@ -116,6 +121,16 @@ bool PSPromotionManager::post_scavenge(YoungGCTracer& gc_tracer) {
     }
     manager->flush_labs();
   }
+#ifdef BDA
+  // Every promotion is done, so the runs of segments of the gc threads that end at
+  // the top can be given back, and the fragmentation stats they recorded folded.
+  // The other runs are kept for the next scavenge.
+  if (UseBDA) {
+    MutableBDASpace * const bda_space = (MutableBDASpace*)old_gen()->object_space();
+    bda_space->retract_segment_caches();
+    bda_space->fold_fragmentation_stats();
+  }
+#endif
   return promotion_failure_occurred;
 }
 
@@ -179,7 +194,7 @@ PSPromotionManager::PSPromotionManager() {
 #ifdef BDA
   bdaref_stack()->initialize();
   if (UseBDA)
-    _bda_old_lab.set_start_array(old_gen()->start_array());
+    _bda_old_labs.initialize(old_gen()->start_array(), old_gen()->bda_space());
 #endif
   queue_size = claimed_stack_depth()->max_elems();
 
@@ -217,7 +232,7 @@ void PSPromotionManager::reset() {
 
 #ifdef BDA
   if (UseBDA)
-    _bda_old_lab.initialize(MemRegion(lab_base, (size_t)0), NULL);
+    _bda_old_labs.reset(lab_base);
 #endif
   
   _old_gen_is_full = false;
@@ -281,8 +296,8 @@ void PSPromotionManager::flush_labs() {
     _old_lab.flush();
 
 #ifdef BDA
-  if (UseBDA && !_bda_old_lab.is_flushed())
-    _bda_old_lab.flush();
+  if (UseBDA)
+    _bda_old_labs.flush();
 #endif
   
   // Let PSScavenge know if we overflowed
@@ -383,8 +398,9 @@ oop PSPromotionManager::oop_promotion_failed(oop obj, markOop obj_mark) {
  * depth-first.
  */
 void
-PSPromotionManager::drain_bda_stacks()
+PSPromotionManager::drain_bda_stacks(bool totally_drain)
 {
+  totally_drain = totally_drain || _totally_drain;
   BDARefTaskQueue * const tq = bdaref_stack();
 
   do {
@@ -395,14 +411,19 @@ PSPromotionManager::drain_bda_stacks()
       process_popped_bdaref_depth<oop>(p);
     }
 
-    while (tq->pop_local(p)) {
-      process_popped_bdaref_depth<oop>(p);
+    if (totally_drain) {
+      while (tq->pop_local(p)) {
+        process_popped_bdaref_depth<oop>(p);
+      }
+    } else {
+      while (tq->size() > _target_stack_size && tq->pop_local(p)) {
+        process_popped_bdaref_depth<oop>(p);
+      }
     }
-    
-  } while (!tq->taskqueue_empty() || !tq->overflow_empty());
+  } while (totally_drain && !tq->taskqueue_empty() || !tq->overflow_empty());
 
-  assert(tq->taskqueue_empty(), "Sanity");
-  assert(tq->size() <= _target_stack_size, "Sanity");
+  assert(!totally_drain || tq->taskqueue_empty(), "Sanity");
+  assert(totally_drain || tq->size() <= _target_stack_size, "Sanity");
   assert(tq->overflow_empty(), "Sanity");
 }
 
@@ -90,10 +90,12 @@ class PSPromotionManager VALUE_OBJ_CLASS_SPEC {
   OverflowTaskQueue<oop, mtGC>        _claimed_stack_breadth;
 
 #ifdef BDA
-  BDAOldPromotionLAB                  _bda_old_lab;
+  BDAOldPromotionLABSet               _bda_old_labs;
   BDARefTaskQueue                     _bdaref_stack;
   BDAPromotionStats                   _promotion_stats;
   container_t                         _filling_segment;
+  // Selects the segment caches of this manager in the bda-spaces
+  uint                                _worker_id;
   static BDARefTaskQueueSet *         _bda_stack_array;
 #endif
   
@@ -225,8 +227,9 @@ class PSPromotionManager VALUE_OBJ_CLASS_SPEC {
                                                               int end,
                                                               container_t ct);
 
-  // Drain the refstack
-  void drain_bda_stacks();
+  // Drain the refstack. If not totally drained, the last entries are left for
+  // other threads to steal.
+  void drain_bda_stacks(bool totally_drain = true);
   // Close the segment this thread was filling
   void fill_last_segment();
   // set the container this GCThread is filling
@@ -33,6 +33,7 @@
 
 #ifdef BDA
 # include "bda/bdaScavenge.inline.hpp"
+# include "bda/mutableBDASpace.inline.hpp"
 #endif
 
 inline PSPromotionManager* PSPromotionManager::manager_array(int index) {
@@ -282,7 +283,8 @@ PSPromotionManager::copy_bdaref_to_survivor_space(oop o, void * r, RefQueue::Ref
     // If it is RefType::container
     if (rt) {
       // Allocate a container on the correct bda-space (already pushes new_obj_size)
-      container = old_space -> allocate_container(new_obj_size, (BDARegion*)r);
+      container = old_space -> allocate_container(new_obj_size, (BDARegion*)r, _worker_id,
+                                                  old_space -> numa_node_of(o));
 
       // Usually, the MutableBDASpace prepares for this scenario.
       // It allocates the new container in the general object space. However,
@@ -320,6 +322,7 @@ PSPromotionManager::copy_bdaref_to_survivor_space(oop o, void * r, RefQueue::Ref
         // lost the cas header race
         guarantee(o->is_forwarded(), "Object must be forwarded if the cas failed.");
         // Deallocate the object. In this case, the container is left empty.
+        old_space->note_segment_top(container, container->_top, container->_start, _worker_id);
         container->_top = container->_start;
         // Dont't update this before the unallocation!
         new_obj = o->forwardee();
@@ -330,19 +333,25 @@ PSPromotionManager::copy_bdaref_to_survivor_space(oop o, void * r, RefQueue::Ref
 
       // Tries to allocate. It fails if the lab has no space left or if the lab
       // is not targeted for this container/segment
-      new_obj = (oop) _bda_old_lab.allocate (new_obj_size, container);
+      new_obj = (oop) _bda_old_labs.allocate (new_obj_size, container);
 
       if (new_obj == NULL) {
-        if (new_obj_size > (BDAOldPLABSize / 2)) {
+        if (new_obj_size > (_bda_old_labs.desired_words(container) / 2)) {
           // Allocate directly
-          new_obj = (oop) old_space -> allocate_element (new_obj_size, container);
+          new_obj = (oop) old_space -> allocate_element (new_obj_size, container, _worker_id);
         } else {
-          // Allocate new lab, flush and fill
-          HeapWord * lab_base = old_space -> allocate_plab (container);
+          // Take the lab of the container (or the least recently used one) and
+          // flush it first, so that its free words may go to the new lab.
+          BDAOldPromotionLAB * lab = _bda_old_labs.lab_for (container);
+          if (!lab->is_flushed()) {
+            lab->flush();
+          }
+          const size_t lab_sz = lab->desired_words();
+          container_t key = container;
+          HeapWord * lab_base = old_space -> allocate_plab (container, lab_sz, _worker_id);
           if (lab_base != NULL) {
-            _bda_old_lab.flush();
-            _bda_old_lab.initialize (MemRegion(lab_base, BDAOldPLABSize), container);
-            new_obj = (oop) _bda_old_lab.allocate (new_obj_size, container);
+            lab->initialize (MemRegion(lab_base, lab_sz), key, container);
+            new_obj = (oop) lab->allocate (new_obj_size, container);
           }
         }
       }
@@ -377,7 +386,7 @@ PSPromotionManager::copy_bdaref_to_survivor_space(oop o, void * r, RefQueue::Ref
         // lost the cas header race
         guarantee(o->is_forwarded(), "Object must be forwarded if the cas failed.");
         // Unallocate the object
-        if (!_bda_old_lab.unallocate_object ((HeapWord *) new_obj, new_obj_size)) {
+        if (!_bda_old_labs.unallocate_object ((HeapWord *) new_obj, new_obj_size)) {
           // If it could not unallocate, fill with a filler to leave this part unusable.
           CollectedHeap::fill_with_object((HeapWord*) new_obj, new_obj_size);
         }
@@ -57,6 +57,7 @@
 #include "utilities/stack.inline.hpp"
 
 #ifdef BDA
+# include "bda/bdaPhaseTimes.hpp"
 # include "bda/bdaTasks.hpp"
 # include "bda/mutableBDASpace.inline.hpp"
 #endif
@@ -420,31 +421,46 @@ bool PSScavenge::invoke_no_policy() {
       ParallelTaskTerminator bda_phase_terminator(
         active_workers,
         (TaskQueueSetSuper*) promotion_manager->bda_stack_array());
-      if (active_workers > 1) {
-        for (uint j = 0; j < active_workers; j++) {
-          q->enqueue(new StealBDARefTask(&bda_phase_terminator));
-        }
-      }
-      
+
       // Enqueue bda scavenge tasks
       if (UseBDA) {
-        // Are the bda-spaces not empty? Queue tasks to scan old-to-young refs
-        if (!bda_manager->is_bdaspace_empty()) {
-          bda_manager->save_tops_for_scavenge();
-          
-          for (uint i = 0; i < active_workers; i++) {
-            q->enqueue(new OldToYoungBDARootsTask(old_gen, i, active_workers));
+        BDAPhaseTimes * phase_times = bda_manager->phase_times();
+        phase_times->note_gc_start(false);
+        RefQueue * refqueue = Universe::heap()->bda_refqueue();
+        jint n_chunks = 0;
+        jint n_batches = 0;
+        {
+          BDASerialPhaseTimer tm_rs(phase_times, BDAPhaseTimes::RootSetup,
+                                    false, false, &_gc_timer, _gc_tracer.gc_id());
+          // Are the bda-spaces not empty? Save the segments to scan for old-to-young refs
+          if (!bda_manager->is_bdaspace_empty()) {
+            n_chunks = bda_manager->save_tops_for_scavenge(card_table());
           }
+          // Scan the refqueue to search for new bda roots. The roots still logged in
+          // the threads' local buffers must be moved to the refqueue first.
+          CollectedHeap::flush_bda_root_buffers();
+          n_batches = refqueue->prepare_batches();
         }
 
-        // Scan the refqueue to search for new bda roots
-        RefQueue * refqueue = Universe::heap()->bda_refqueue();
-        if (!refqueue->is_empty()) {
+        if (n_chunks > 0) {
+          for (uint i = 0; i < active_workers; i++) {
+            q->enqueue(new OldToYoungBDARootsTask(old_gen));
+          }
+        }
+        if (n_batches > 0) {
           for (uint j = 0; j < active_workers; j++) {
             q->enqueue(new BDARefRootsTask(refqueue, old_gen));
           }
         }
 
+        // The steal tasks must follow the tasks that fill the bda stacks, or the
+        // workers would terminate the bda phase before there is anything to steal.
+        if (active_workers > 1) {
+          for (uint j = 0; j < active_workers; j++) {
+            q->enqueue(new StealBDARefTask(&bda_phase_terminator));
+          }
+        }
+
         // There are only old-to-young pointers if there are objects
         // in the other-gen.
         if(!bda_manager->non_bda_space()->is_empty()) {
@@ -748,8 +764,21 @@ bool PSScavenge::invoke_no_policy() {
       if (PrintBDAContentsAtGC) {
         bda_manager->print_spaces_contents();
       }
-      bda_manager->reset_grp_stats();
 #endif // ASSERT
+      {
+        BDASerialPhaseTimer tm(bda_manager->phase_times(), BDAPhaseTimes::Layout,
+                               false, false, &_gc_timer, _gc_tracer.gc_id());
+        bda_manager->resize_segments();
+        if (!promotion_failure_occurred) {
+          // A failed scavenge is followed by a full GC, which restarts the sampling
+          bda_manager->sample_reserved_words();
+          if (BDAAdaptiveSpaceLayout) {
+            bda_manager->adjust_layout(false);
+          }
+        }
+      }
+      bda_manager->update_counters();
+      bda_manager->reset_grp_stats();
       if (BDAPrintAfterGC) {
         bda_manager->print_object_space();
       }
@@ -757,6 +786,16 @@ bool PSScavenge::invoke_no_policy() {
 #endif // BDA
   }
 
+#ifdef BDA
+  if (UseBDA) {
+    BDAPhaseTimes * phase_times = old_gen->bda_space()->phase_times();
+    if (PrintGCDetails) {
+      phase_times->print();
+    }
+    phase_times->report(&_gc_tracer);
+  }
+#endif // BDA
+
   if (VerifyAfterGC && heap->total_collections() >= VerifyGCStartAt) {
     HandleMark hm;  // Discard invalid handles created during verification
     Universe::verify(" VerifyAfterGC:");
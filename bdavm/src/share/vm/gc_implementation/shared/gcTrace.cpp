@@ -89,6 +89,16 @@ void GCTracer::report_gc_reference_stats(const ReferenceProcessorStats& rps) con
   send_reference_stats_event(REF_PHANTOM, rps.phantom_count());
 }
 
+#ifdef BDA
+void GCTracer::report_bda_phase_time(const char* name, uint workers, double min_ms,
+                                     double avg_ms, double max_ms, double sum_ms,
+                                     size_t work_items) const {
+  assert_set_gc_id();
+
+  send_bda_phase_time_event(name, workers, min_ms, avg_ms, max_ms, sum_ms, work_items);
+}
+#endif // BDA
+
 #if INCLUDE_SERVICES
 class ObjectCountEventSenderClosure : public KlassInfoClosure {
   const GCId _gc_id;
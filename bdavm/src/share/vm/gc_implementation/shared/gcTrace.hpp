@@ -127,6 +127,11 @@ class GCTracer : public ResourceObj {
   void report_metaspace_summary(GCWhen::Type when, const MetaspaceSummary& metaspace_summary) const;
   void report_gc_reference_stats(const ReferenceProcessorStats& rp) const;
   void report_object_count_after_gc(BoolObjectClosure* object_filter) NOT_SERVICES_RETURN;
+#ifdef BDA
+  // Times of a parallel phase of the bda-spaces, over the workers that ran it
+  void report_bda_phase_time(const char* name, uint workers, double min_ms, double avg_ms,
+                             double max_ms, double sum_ms, size_t work_items) const;
+#endif // BDA
   bool has_reported_gc_start() const;
   const GCId& gc_id() { return _shared_gc_info.gc_id(); }
 
@@ -142,6 +147,10 @@ class GCTracer : public ResourceObj {
   void send_metaspace_chunk_free_list_summary(GCWhen::Type when, Metaspace::MetadataType mdtype, const MetaspaceChunkFreeListSummary& summary) const;
   void send_reference_stats_event(ReferenceType type, size_t count) const;
   void send_phase_events(TimePartitions* time_partitions) const;
+#ifdef BDA
+  void send_bda_phase_time_event(const char* name, uint workers, double min_ms, double avg_ms,
+                                 double max_ms, double sum_ms, size_t work_items) const;
+#endif // BDA
 };
 
 class YoungGCTracer : public GCTracer {
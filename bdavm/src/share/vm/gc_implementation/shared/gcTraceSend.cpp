@@ -64,6 +64,25 @@ void GCTracer::send_reference_stats_event(ReferenceType type, size_t count) cons
   }
 }
 
+#ifdef BDA
+void GCTracer::send_bda_phase_time_event(const char* name, uint workers, double min_ms,
+                                         double avg_ms, double max_ms, double sum_ms,
+                                         size_t work_items) const {
+  EventGCBDAPhaseTime e;
+  if (e.should_commit()) {
+      e.set_gcId(_shared_gc_info.gc_id().id());
+      e.set_name(name);
+      e.set_workers(workers);
+      e.set_minTime(min_ms);
+      e.set_averageTime(avg_ms);
+      e.set_maxTime(max_ms);
+      e.set_sumTime(sum_ms);
+      e.set_workItems(work_items);
+      e.commit();
+  }
+}
+#endif // BDA
+
 void GCTracer::send_metaspace_chunk_free_list_summary(GCWhen::Type when, Metaspace::MetadataType mdtype,
                                                       const MetaspaceChunkFreeListSummary& summary) const {
   EventMetaspaceChunkFreeListSummary e;
@@ -590,16 +590,27 @@ void CollectedHeap::post_full_gc_dump(GCTimer* timer) {
 /////////////// BDA Support //////////////
 #if defined(BDA) || defined(BDA_INTERPRETER)
 void
-CollectedHeap::enqueue_asm(JavaThread * java_thread, oop * obj, BDARegion * r)
+CollectedHeap::enqueue_asm(JavaThread * java_thread, oopDesc * obj, BDARegion * r)
 {
   assert (obj != NULL && r != NULL, "neither object and the space can be null");
-  _bda_refqueue->enqueue(*obj, r);
+  // This is a leaf call: no safepoint may happen here, thus obj needs no handle.
+  java_thread->bda_root_buffer().enqueue(obj, r);
   if (PrintEnqueuedContainers) {
     gclog_or_tty->print_cr ("Container reference %16p enqueued for space " INT32_FORMAT,
-                            *obj,
-                            exact_log2((intptr_t)r->value()));
+                            obj,
+                            r->space_id());
   }
 }
+
+void
+CollectedHeap::flush_bda_root_buffers()
+{
+  assert (SafepointSynchronize::is_at_safepoint(), "must be at a safepoint");
+  for (JavaThread * jt = Threads::first(); jt != NULL; jt = jt->next()) {
+    jt->bda_root_buffer().flush();
+  }
+  _bda_refqueue->flush_shared_buffer();
+}
 #endif // BDA || BDA_INTERPRETER
 
 
@@ -205,12 +205,19 @@ class CollectedHeap : public CHeapObj<mtInternal> {
   }
 
 #if defined(BDA) || defined(BDA_INTERPRETER)
-  // This function is called by the TemplateInterpreter when r is a valid bda-space
-  static void enqueue_asm(JavaThread * java_thread, oop * obj, BDARegion * r);
+  // This function is called (as a leaf) by the TemplateInterpreter and by C2-compiled
+  // code when the thread's bda root buffer is full, or not yet allocated, and r is a valid bda-space.
+  static void enqueue_asm(JavaThread * java_thread, oopDesc * obj, BDARegion * r);
+  // Enqueues a new bda root on the calling thread's buffer, if it is a JavaThread,
+  // or on the shared buffer of the refqueue otherwise.
+  static inline void enqueue_bda_root(Thread * thread, oop obj, BDARegion * r);
+  // Flushes the bda root buffers of every JavaThread to the refqueue. Must be called
+  // at a safepoint, before the refqueue is drained.
+  static void flush_bda_root_buffers();
   // Getter for the instance of the bda refqueue, which although it is static
   // it needs to be created or it is just NULL
   RefQueue * bda_refqueue() { return _bda_refqueue; }
-  bool     clear_refqueue() { bda_refqueue()->clear(); }
+  bool     clear_refqueue() { return bda_refqueue()->clear(); }
 #endif // BDA || BDA_INTERPRETER
 
   virtual CollectedHeap::Name kind() const { return CollectedHeap::Abstract; }
@@ -176,20 +176,39 @@ HeapWord* CollectedHeap::common_mem_allocate_init(KlassHandle klass, size_t size
   init_obj(obj, size);
 #if defined(BDA) || defined(BDA_INTERPRETER)
   // Enqueues a new possible container, based on the test
-  // on the KlassRegionMap, on the refqueue for later GC processing
-  BDARegion * r;
-  if((r = KlassRegionMap::is_bda_klass(klass())) != NULL) {
-    Universe::heap()->bda_refqueue()->enqueue((oop)obj, r);
+  // on the KlassRegionMap, on the refqueue for later GC processing.
+  // If the 'new' of the object is an allocation site, the site decides instead.
+  // The site is taken, since the allocation may call back into Java.
+  BDARegion * r = KlassRegionMap::is_bda_klass(klass());
+  BDARegion * const site = THREAD->bda_site_region();
+  if (site != NULL) {
+    THREAD->set_bda_site_region(NULL);
+    r = KlassRegionMap::region_for_site(r, site);
+  }
+  if(r != NULL) {
+    enqueue_bda_root(THREAD, (oop)obj, r);
     if (PrintEnqueuedContainers) {
       gclog_or_tty->print_cr ("Container reference %16p enqueued for space " INT32_FORMAT,
                               obj,
-                              exact_log2((intptr_t)r->value()));
+                              r->space_id());
     }
   }
 #endif
   return obj;
 }
 
+#if defined(BDA) || defined(BDA_INTERPRETER)
+inline void
+CollectedHeap::enqueue_bda_root(Thread * thread, oop obj, BDARegion * r)
+{
+  if (thread->is_Java_thread()) {
+    ((JavaThread*)thread)->bda_root_buffer().enqueue(obj, r);
+  } else {
+    _bda_refqueue->enqueue(obj, r);
+  }
+}
+#endif // BDA || BDA_INTERPRETER
+
 HeapWord* CollectedHeap::allocate_from_tlab(KlassHandle klass, Thread* thread, size_t size) {
   assert(UseTLAB, "should use UseTLAB");
 
@@ -171,6 +171,11 @@ IRT_ENTRY(void, InterpreterRuntime::_new(JavaThread* thread, ConstantPool* pool,
   //       Java).
   //       If we have a breakpoint, then we don't rewrite
   //       because the _breakpoint bytecode would be lost.
+#if defined(BDA) || defined(BDA_INTERPRETER)
+  // Methods with bda allocation sites always get here (see TemplateTable::_new)
+  BDAAllocSiteMark site_mark(thread, UseBDA && KlassRegionMap::has_alloc_sites() ?
+                             method(thread)->bda_region_at(bci(thread)) : NULL);
+#endif
   oop obj = klass->allocate_instance(CHECK);
   thread->set_vm_result(obj);
 IRT_END
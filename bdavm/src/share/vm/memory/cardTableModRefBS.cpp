@@ -67,6 +67,11 @@ CardTableModRefBS::CardTableModRefBS(MemRegion whole_heap,
   _cur_covered_regions(0),
   _byte_map(NULL),
   byte_map_base(NULL),
+#ifdef BDA
+  _bda_summary(NULL),
+  _bda_summary_size(0),
+  bda_summary_base(NULL),
+#endif
   // LNC functionality
   _lowest_non_clean(NULL),
   _lowest_non_clean_chunk_size(NULL),
@@ -130,6 +135,19 @@ void CardTableModRefBS::initialize() {
                             !ExecMem, "card table last card");
   *guard_card = last_card;
 
+#if defined(BDA) && !defined(SHARK)
+  if (UseBDA) {
+    const uintptr_t first_entry = uintptr_t(low_bound) >> bda_summary_shift;
+    const uintptr_t last_entry = uintptr_t(high_bound - 1) >> bda_summary_shift;
+    _bda_summary_size = last_entry - first_entry + 1;
+    _bda_summary = NEW_C_HEAP_ARRAY(jbyte, _bda_summary_size, mtGC);
+    // Every card may be dirty until the first scavenge claims the summary
+    memset(_bda_summary, dirty_card, _bda_summary_size);
+    bda_summary_base = _bda_summary - first_entry;
+    assert(bda_summary_for(low_bound) == &_bda_summary[0], "Checking start of bda summary");
+  }
+#endif
+
   _lowest_non_clean =
     NEW_C_HEAP_ARRAY(CardArr, _max_covered_regions, mtGC);
   _lowest_non_clean_chunk_size =
@@ -187,6 +205,13 @@ CardTableModRefBS::~CardTableModRefBS() {
     FREE_C_HEAP_ARRAY(int, _last_LNC_resizing_collection, mtGC);
     _last_LNC_resizing_collection = NULL;
   }
+#ifdef BDA
+  if (_bda_summary) {
+    FREE_C_HEAP_ARRAY(jbyte, _bda_summary, mtGC);
+    _bda_summary = NULL;
+    bda_summary_base = NULL;
+  }
+#endif
 }
 
 int CardTableModRefBS::find_covering_region_by_base(HeapWord* base) {
@@ -550,8 +575,40 @@ void CardTableModRefBS::dirty_MemRegion(MemRegion mr) {
     *cur = dirty_card;
     cur++;
   }
+#ifdef BDA
+  if (bda_summary_base != NULL) {
+    jbyte* cur_entry  = bda_summary_for(mr.start());
+    jbyte* last_entry = bda_summary_for(mr.last());
+    while (cur_entry <= last_entry) {
+      *cur_entry = dirty_card;
+      cur_entry++;
+    }
+  }
+#endif
 }
 
+#ifdef BDA
+bool CardTableModRefBS::claim_bda_summary(HeapWord* start, HeapWord* end) {
+  assert(SafepointSynchronize::is_at_safepoint(), "must be at a safepoint");
+  assert(((uintptr_t)start & (right_n_bits(bda_summary_shift))) == 0, "Unaligned start");
+  assert(((uintptr_t)end & (right_n_bits(bda_summary_shift))) == 0, "Unaligned end");
+  if (bda_summary_base == NULL) {
+    return true;
+  }
+  jbyte* cur_entry  = bda_summary_for(start);
+  jbyte* last_entry = bda_summary_for(end - 1);
+  bool dirty = false;
+  while (cur_entry <= last_entry) {
+    if (*cur_entry != clean_card) {
+      *cur_entry = clean_card;
+      dirty = true;
+    }
+    cur_entry++;
+  }
+  return dirty;
+}
+#endif
+
 void CardTableModRefBS::invalidate(MemRegion mr, bool whole_heap) {
   assert((HeapWord*)align_size_down((uintptr_t)mr.start(), HeapWordSize) == mr.start(), "Unaligned start");
   assert((HeapWord*)align_size_up  ((uintptr_t)mr.end(),   HeapWordSize) == mr.end(),   "Unaligned end"  );
@@ -103,6 +103,10 @@ class CardTableModRefBS: public ModRefBarrierSet {
   const size_t    _page_size;        // page size used when mapping _byte_map
   size_t          _byte_map_size;    // in bytes
   jbyte*          _byte_map;         // the card marking array
+#ifdef BDA
+  jbyte*          _bda_summary;      // the summary of _byte_map (see bda_summary_base)
+  size_t          _bda_summary_size; // in bytes
+#endif
 
   int _cur_covered_regions;
   // The covered regions should be in address order.
@@ -339,6 +343,14 @@ public:
     } else {
       *byte = dirty_card;
     }
+#ifdef BDA
+    if (bda_summary_base != NULL) {
+      jbyte* entry = bda_summary_for((void*)field);
+      if (*entry != dirty_card) {
+        *entry = dirty_card;
+      }
+    }
+#endif
   }
 
   // These are used by G1, when it uses the card table as a temporary data
@@ -361,6 +373,35 @@ public:
   // before the beginning of the actual _byte_map.
   jbyte* byte_map_base;
 
+#ifdef BDA
+  // Summary of the card marking array, only allocated with UseBDA. It has one
+  // entry per slot of the bda-spaces (MutableBDASpace::MinRegionSize words), which
+  // the write barriers dirty together with the card. Since the segments of the
+  // bda-spaces span whole slots, a segment whose entries are clean has no dirty
+  // card and the scavenge skips it without looking at its cards. It is biased
+  // like byte_map_base, and clearing cards leaves it untouched, so an entry may
+  // be dirty while its cards are clean, but never the other way around. The
+  // barriers only store to an entry that is not dirty yet: the entries of the
+  // young gen and of the non-bda space are never claimed, so they stay dirty and
+  // the stores there cost a load. Shark does not dirty the summary, so it is not
+  // allocated in Shark builds and the scavenge looks at every card.
+  enum BDASummaryConstants {
+    bda_summary_shift = LogHeapWordSize + 16
+  };
+  jbyte* bda_summary_base;
+
+  jbyte* bda_summary_for(const void* p) const {
+    jbyte* result = &bda_summary_base[uintptr_t(p) >> bda_summary_shift];
+    assert(result >= _bda_summary && result < _bda_summary + _bda_summary_size,
+           "out of bounds accessor for bda summary");
+    return result;
+  }
+  // Returns whether a card of the slot aligned [start, end) may be dirty, and
+  // resets the summary of the range to clean. Must be called at a safepoint,
+  // before the cards of the range may be dirtied by the gc threads.
+  bool claim_bda_summary(HeapWord* start, HeapWord* end);
+#endif
+
   // Return true if "p" is at the start of a card.
   bool is_card_aligned(HeapWord* p) {
     jbyte* pcard = byte_for(p);
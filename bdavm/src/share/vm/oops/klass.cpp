@@ -194,6 +194,9 @@ Klass::Klass() {
   clear_modified_oops();
   clear_accumulated_modified_oops();
   _shared_class_path_index = -1;
+#if defined(BDA) || defined(BDA_INTERPRETER)
+  _bda_region = NULL;
+#endif // BDA || BDA_INTERPRETER
 }
 
 jint Klass::array_layout_helper(BasicType etype) {
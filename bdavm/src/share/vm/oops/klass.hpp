@@ -42,9 +42,9 @@
 #endif // INCLUDE_ALL_GCS
 
 // Big Data alloc support
-#ifdef BDA
+#if defined(BDA) || defined(BDA_INTERPRETER)
 #include "bda/bdaGlobals.hpp"
-#endif // BDA
+#endif // BDA || BDA_INTERPRETER
 
 //
 // A Klass provides:
@@ -181,6 +181,12 @@ class Klass : public Metadata {
   jbyte _modified_oops;             // Card Table Equivalent (YC/CMS support)
   jbyte _accumulated_modified_oops; // Mod Union Equivalent (CMS support)
 
+#if defined(BDA) || defined(BDA_INTERPRETER)
+  // The bda-space of the objects of this klass, if it is a container klass, or NULL.
+  // Cached here so that generated code can test it with a single load.
+  BDARegion* _bda_region;
+#endif // BDA || BDA_INTERPRETER
+
 private:
   // This is an index into FileMapHeader::_classpath_entry_table[], to
   // associate this class with the JAR file where it's loaded from during
@@ -324,6 +330,9 @@ protected:
   static ByteSize modifier_flags_offset()        { return in_ByteSize(offset_of(Klass, _modifier_flags)); }
   static ByteSize layout_helper_offset()         { return in_ByteSize(offset_of(Klass, _layout_helper)); }
   static ByteSize access_flags_offset()          { return in_ByteSize(offset_of(Klass, _access_flags)); }
+#if defined(BDA) || defined(BDA_INTERPRETER)
+  static ByteSize bda_region_offset()            { return in_ByteSize(offset_of(Klass, _bda_region)); }
+#endif // BDA || BDA_INTERPRETER
 
   // Unpacking layout_helper:
   enum {
@@ -724,6 +733,10 @@ protected:
  public:
   // Big Data allocators support
   // bool is_subtype_for_bda();
+#if defined(BDA) || defined(BDA_INTERPRETER)
+  BDARegion* bda_region() const           { return _bda_region; }
+  void       set_bda_region(BDARegion* r) { _bda_region = r; }
+#endif // BDA || BDA_INTERPRETER
 };
 
 #endif // SHARE_VM_OOPS_KLASS_HPP
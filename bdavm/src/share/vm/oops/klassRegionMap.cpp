@@ -1,105 +1,52 @@
 #include "precompiled.hpp"
 #include "oops/klassRegionMap.hpp"
-#include "utilities/hashtable.inline.hpp"
 #include "memory/allocation.hpp"
+#include "interpreter/bytecode.hpp"
+#include "oops/instanceKlass.hpp"
+#include "oops/method.hpp"
+#include "runtime/java.hpp"
+#include "runtime/mutexLocker.hpp"
+#include "runtime/orderAccess.inline.hpp"
+#include "runtime/vframe.hpp"
 
 // Static definition
 
 GrowableArray<KlassRegionMap::KlassRegionEl*>* KlassRegionMap::_bda_class_names = NULL;
-KlassRegionHashtable* KlassRegionMap::_region_map = NULL;
+GrowableArray<KlassRegionMap::KlassRegionEl*>* KlassRegionMap::_bda_site_names = NULL;
+Symbol* const* volatile KlassRegionMap::_bda_site_klasses = NULL;
 BDARegion* KlassRegionMap::_region_data = NULL;
 int        KlassRegionMap::_region_data_sz = 0;
-volatile bdareg_t KlassRegionMap::_next_region = BDARegion::region_start;
-
-// KlassRegion Hashtables definition
-
-KlassRegionHashtable::KlassRegionHashtable(int table_size)
-  : Hashtable<BDARegion*, mtGC>(table_size, sizeof(KlassRegionEntry)) {
-}
-
-KlassRegionEntry*
-KlassRegionHashtable::add_entry(Klass* k, BDARegion* region)
-{
-  unsigned int compressed_ptr;
-  if(UseCompressedClassPointers) {
-    compressed_ptr = (unsigned int)Klass::encode_klass_not_null(k);
-  } else {
-    compressed_ptr = (uintptr_t)k & 0xFFFFFFFF;
-  }
-  KlassRegionEntry* entry = (KlassRegionEntry*)Hashtable<BDARegion*, mtGC>::new_entry(compressed_ptr, region); entry->set_klass(k);
-
-  BasicHashtable<mtGC>::add_entry(hash_to_index(compressed_ptr), entry);
-
-  return entry;
-}
-
-__attribute__((optimize("O0")))
-BDARegion*
-KlassRegionHashtable::get_region(Klass* k)
-{
-  // Give the default entry for the general types initialized at vm startup,
-  // i.e. before any entry is added when loading classes
-  if(!number_of_entries())
-    return KlassRegionMap::no_region_ptr();
-
-  int i;
-  if (UseCompressedClassPointers) {
-    i = hash_to_index((unsigned int)Klass::encode_klass_not_null(k));
-  } else {
-    i = hash_to_index((uintptr_t)k & 0xFFFFFFFF);
-  }
-  KlassRegionEntry* entry = (KlassRegionEntry*)bucket(i);
-  // this can happen with vm loaded classes, i.e. those that do not rely on the
-  // classFileParser for loading the .class
-  if(entry == NULL) {
-    entry = this->add_entry(k, KlassRegionMap::region_elem(BDARegion::region_start));
-  } else if (entry->next() != NULL) {
-    while (entry->get_klass() != k) {
-      entry = entry->next();
-      if(entry == NULL) {
-        entry = this->add_entry(k,
-                                KlassRegionMap::region_start_ptr());
-      }
-      assert(entry != NULL, "klass pointer placed incorrectly");
-    }
-  }
-  return entry->literal();
-}
+int        KlassRegionMap::_last_space_id = 0;
 
 // KlassRegionMap definition
 
 KlassRegionMap::KlassRegionMap()
 {
-  _next_region = BDARegion::region_start;
+  _last_space_id = 0;
   // TODO: This should change to a normal array. Why a growableArray if it is not to grow
   // (unless it is...)?
   _bda_class_names = new (ResourceObj::C_HEAP, mtGC)GrowableArray<KlassRegionEl*>(0,true);
+  _bda_site_names = new (ResourceObj::C_HEAP, mtGC)GrowableArray<KlassRegionEl*>(0,true);
+  Symbol** no_klasses = NEW_C_HEAP_ARRAY(Symbol*, 1, mtGC);
+  no_klasses[0] = NULL;
+  _bda_site_klasses = no_klasses;
   parse_from_string(BDAKlasses, KlassRegionMap::parse_from_line);
 
-  // 2 times each 'interesting' class (container and element) and 2 more for
+  // 2 times each 'interesting' class or site (container and element) and 2 more for
   // region_start and no_region. Initialize it.
-  _region_data_sz = 2 * _bda_class_names->length() + 2;
+  _region_data_sz = 2 * number_bdaregions() + 2;
   _region_data = NEW_C_HEAP_ARRAY(BDARegion, _region_data_sz, mtGC);
-  _region_data[0] = BDARegion(BDARegion::no_region);
-  _region_data[1] = BDARegion(BDARegion::region_start);
-  bdareg_t reg = BDARegion::region_start;
-  for(int j = 2; j < _region_data_sz; j += 2) {
-    reg <<= BDARegion::region_shift;
-    // the no_region is occupying idx 0
-    int idx = log2_intptr((intptr_t)reg)*2;
-    _region_data[idx] = BDARegion(reg); _region_data[idx+1] = BDARegion(reg | 0x1);
+  // Each region is at the index of its value, the no_region occupying idx 0
+  for(int idx = 0; idx < _region_data_sz; ++idx) {
+    _region_data[idx] = BDARegion((bdareg_t)idx);
   }
   // Set the limits on the BDARegion
   BDARegion::set_region_start(_region_data);
   BDARegion::set_region_end(&_region_data[_region_data_sz - 1]);
-
-  int table_size = 4096;
-  _region_map = new KlassRegionHashtable(table_size);
 }
 
 KlassRegionMap::~KlassRegionMap()
 {
-  delete _region_map;
 }
 
 void
@@ -129,13 +76,24 @@ void
 KlassRegionMap::parse_from_line(char* line)
 {
   // Accept dots '.' and slashes '/' but not mixed.
-  // TODO: Method names are to be accepted in the future
+  // Allocation sites are given as [!]Holder::method@bci.
   char delimiter;
-  char buffer[64];
+  char buffer[256];
   char* str;
   bool delimiter_found = false;
+  bool excluded = false;
+  const char* method = NULL;
   int i = 0;
-  for(char* c = line; *c != '\0'; c++) {
+  char* c = line;
+  if (*c == '!') {
+    excluded = true;
+    c++;
+  }
+  for(; *c != '\0'; c++) {
+    if(*c == ':' && *(c + 1) == ':') {
+      method = c + 2;
+      break;
+    }
     if(*c == '.' && !delimiter_found) {
       delimiter_found = true;
       delimiter = '.';
@@ -150,72 +108,144 @@ KlassRegionMap::parse_from_line(char* line)
   }
 
   // This saves the hassle of dealing with empty class names
-  if (i != 0) {
-    buffer[i] = '\0';
-    str = NEW_C_HEAP_ARRAY(char, i + 1, mtGC);
-    strcpy(str, buffer);
-    // construct the object and push while shifting the _next_region value
-    KlassRegionEl* el = new KlassRegionEl(str, _next_region <<= BDARegion::region_shift);
+  if (i == 0) {
+    return;
+  }
+  buffer[i] = '\0';
+  str = NEW_C_HEAP_ARRAY(char, i + 1, mtGC);
+  strcpy(str, buffer);
+
+  if (method == NULL) {
+    // construct the object and push it with the region of the next space
+    KlassRegionEl* el = new KlassRegionEl(str, next_region());
     _bda_class_names->push(el);
+    return;
   }
+
+  const char* at = strchr(method, '@');
+  int bci = at != NULL ? atoi(at + 1) : -1;
+  int len = at != NULL ? (int)(at - method) : 0;
+  if (len == 0 || bci < 0) {
+    warning("BDAKlasses: ignoring malformed allocation site %s, expected Holder::method@bci", line);
+    FREE_C_HEAP_ARRAY(char, str, mtGC);
+    return;
+  }
+  char* method_str = NEW_C_HEAP_ARRAY(char, len + 1, mtGC);
+  strncpy(method_str, method, len);
+  method_str[len] = '\0';
+  // excluded sites do not get a region of their own
+  bdareg_t r = excluded ? BDARegion::no_region : next_region();
+  _bda_site_names->push(new KlassRegionEl(str, r, method_str, bci));
+}
+
+bdareg_t
+KlassRegionMap::next_region()
+{
+  if (_last_space_id == BDARegion::max_space_id) {
+    vm_exit_during_initialization("BDAKlasses names more regions than the bda-spaces support");
+  }
+  return BDARegion::container_of_space(++_last_space_id);
+}
+
+BDARegion*
+KlassRegionMap::region_ptr(bdareg_t r)
+{
+  return region_elem(r);
 }
 
 BDARegion*
-KlassRegionMap::is_bda_klass(Klass* k)
+KlassRegionMap::bda_type(const char* name)
 {
-  BDARegion * r = region_for_klass(k);
-  if(r != no_region_ptr() && r != region_start_ptr())
-    return r;
-  else
+  int i = _bda_class_names->find((void*)name, KlassRegionEl::equals_name);
+  if (i < 0) {
     return NULL;
+  }
+  return region_ptr(_bda_class_names->at(i)->region_id());
 }
 
-// Doesn't need return type since it is set by the thread
 void
-KlassRegionMap::is_bda_klass_asm(JavaThread* java_thread, Klass* k)
+KlassRegionMap::add_site_entries(Klass* k)
 {
-  // Get the region ptr
-  BDARegion * r = is_bda_klass(k);
-  // Set it as the thread's call vm result
-  java_thread->set_vm_result((oop)r);
+  if (!has_alloc_sites() || !k->oop_is_instance()) {
+    return;
+  }
+  const char* name = k->external_name();
+  Array<Method*>* methods = InstanceKlass::cast(k)->methods();
+  for (int s = 0; s < _bda_site_names->length(); s++) {
+    KlassRegionEl* el = _bda_site_names->at(s);
+    if (strcmp(name, el->klass_name()) != 0) {
+      continue;
+    }
+    bool found = false;
+    for (int j = 0; j < methods->length(); j++) {
+      Method* m = methods->at(j);
+      if (!m->name()->equals(el->method_name(), (int)strlen(el->method_name())) ||
+          el->bci() >= m->code_size() || m->java_code_at(el->bci()) != Bytecodes::_new) {
+        continue;
+      }
+      // Overloaded methods with a 'new' at the same bci share the site.
+      m->add_bda_site(el->bci(), region_ptr(el->region_id()));
+      found = true;
+      add_site_klass(m->constants()->klass_name_at(
+        (int)Bytecode_new(m, m->bcp_from(el->bci())).index()));
+      if (TraceBDAClassAssociation) {
+        gclog_or_tty->print_cr ("(Trace Class Association) added %s site: "
+                                INT32_FORMAT " <-> %s::%s@%d",
+                                el->is_excluded() ? "excluded" : "bda",
+                                el->region_id(), name, el->method_name(), el->bci());
+      }
+    }
+    if (!found) {
+      warning("BDAKlasses: there is no 'new' at allocation site %s::%s@%d",
+              name, el->method_name(), el->bci());
+    }
+  }
 }
 
 bool
-KlassRegionMap::is_bda_type(const char* name)
+KlassRegionMap::is_site_klass(Klass* k)
 {
-  if(_bda_class_names->find((char*)name, KlassRegionEl::equals_name) >= 0)
-  {
-    return true;
-  } else {
+  if (!has_alloc_sites() || !k->oop_is_instance()) {
     return false;
   }
+  Symbol* const* klasses = (Symbol* const*)OrderAccess::load_ptr_acquire(&_bda_site_klasses);
+  for (int i = 0; klasses[i] != NULL; i++) {
+    if (klasses[i] == k->name()) return true;
+  }
+  return false;
 }
 
-__attribute__((optimize("O0")))
-BDARegion*
-KlassRegionMap::bda_type(Klass* k)
+void
+KlassRegionMap::add_site_klass(Symbol* name)
 {
-  int i = _bda_class_names->find((void*)k->external_name(), KlassRegionEl::equals_name);
-  assert(i >= 0 && i < _bda_class_names->length(), "index out of bounds");
-  bdareg_t r = _bda_class_names->at(i)->region_id();
-  int idx = log2_intptr((intptr_t)r)*2;
-  return &_region_data[idx];
+  MutexLocker ml(BDASiteKlasses_lock);
+  Symbol* const* klasses = _bda_site_klasses;
+  int n = 0;
+  for (; klasses[n] != NULL; n++) {
+    if (klasses[n] == name) return;
+  }
+  Symbol** copy = NEW_C_HEAP_ARRAY(Symbol*, n + 2, mtGC);
+  memcpy(copy, klasses, n * sizeof(Symbol*));
+  name->increment_refcount();
+  copy[n] = name;
+  copy[n + 1] = NULL;
+  OrderAccess::release_store_ptr(&_bda_site_klasses, copy);
 }
 
-__attribute__((optimize("O0")))
 void
 KlassRegionMap::add_entry(Klass* k)
 {
   ResourceMark rm(Thread::current());
+  add_site_entries(k);
   for(juint index = 0; index <= k->super_depth(); ++index) {
     if ( index == Klass::primary_super_limit() ) {
-      add_other_entry(k);
-      return;
-    } else if( k->primary_super_of_depth(index) != NULL &&
-               is_bda_type(k->primary_super_of_depth(index)->external_name())) {
-      // If this is a bda_type (i.e. an interesting class) add to the hashtable
-      // as a BDARegion with non-uniform id.
-      BDARegion* region = bda_type(k->primary_super_of_depth(index));
+      break;
+    }
+    Klass* super = k->primary_super_of_depth(index);
+    BDARegion* region;
+    if (super != NULL && (region = bda_type(super->external_name())) != NULL) {
+      // If this is a bda_type (i.e. an interesting class) save its BDARegion,
+      // with non-uniform id, in the klass.
       add_region_entry(k, region);
       return;
     }
@@ -223,16 +253,30 @@ KlassRegionMap::add_entry(Klass* k)
   add_other_entry(k);
 }
 
-BDARegion*
-KlassRegionMap::region_for_klass(Klass* k)
-{
-  if(_region_map != NULL) return _region_map->get_region(k);
-  return NULL;
-}
-
 int
 KlassRegionMap::number_bdaregions()
 {
   assert(_bda_class_names != NULL, "KlassRegionMap has not been initialized yet");
-  return _bda_class_names->length();
+  int n = _bda_class_names->length();
+  for (int i = 0; i < _bda_site_names->length(); i++) {
+    if (!_bda_site_names->at(i)->is_excluded()) {
+      n++;
+    }
+  }
+  return n;
+}
+
+BDARegion*
+KlassRegionMap::site_region_of_caller(JavaThread* thread)
+{
+  if (!thread->has_last_Java_frame()) {
+    return NULL;
+  }
+  // The allocating method is the top Java frame, even in compiled code where
+  // it may have been inlined.
+  vframeStream vfst(thread);
+  if (vfst.at_end()) {
+    return NULL;
+  }
+  return vfst.method()->bda_region_at(vfst.bci());
 }
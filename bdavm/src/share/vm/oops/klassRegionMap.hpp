@@ -2,77 +2,58 @@
 #define SHARE_VM_OOPS_KLASSREGIONMAP_HPP
 
 #include "bda/bdaGlobals.hpp"
-#include "utilities/hashtable.hpp"
+#include "oops/klass.hpp"
 #include "utilities/growableArray.hpp"
 #include "memory/resourceArea.hpp"
 
-/**
- * The Hashtable for the mapping between region identifiers and Klass objects.
- */
-
-class KlassRegionEntry;
-class ResourceMark;
-
-class KlassRegionHashtable : public Hashtable<BDARegion*, mtGC> {
-
- public:
-  KlassRegionHashtable(int table_size);
-
-  void add_entry(int index, KlassRegionEntry* entry) {
-    Hashtable<BDARegion*, mtGC>::add_entry(index, (HashtableEntry<BDARegion*, mtGC>*)entry);
-  }
-
-  KlassRegionEntry* add_entry(Klass* k, BDARegion* region);
-  BDARegion* get_region(Klass* k);
-};
-
-class KlassRegionEntry : public HashtableEntry<BDARegion*, mtGC> {
-
- private:
-  Klass* _klass; // actual klass for conflict resolution
-
- public:
-  KlassRegionEntry* next() const {
-    return (KlassRegionEntry*)HashtableEntry<BDARegion*, mtGC>::next();
-  }
-
-  KlassRegionEntry** next_addr() {
-    return (KlassRegionEntry**)HashtableEntry<BDARegion*, mtGC>::next_addr();
-  }
-
-  Klass* get_klass()         { return _klass; }
-  void   set_klass(Klass* k) { _klass = k; }
-};
-
-
 /* The actual class that manages the mapping between region ids and Klass objects.
  * Several fields and methods are static, since we're assuming there's always just one
  * instance of this class.
+ * The region of each bda klass is resolved once, when the klass is parsed, and saved
+ * in the Klass itself (see Klass::bda_region()), so looking it up is a single load.
+ * Entries of the form "Holder::method@bci" name allocation sites instead of klasses:
+ * each gets its own region, saved in the method (see Method::bda_region_at()), which
+ * is used instead of the region of the allocated klass. A site prefixed with '!' is
+ * excluded, i.e., objects allocated there are never registered as containers.
+ * The site of an allocation is passed by the 'new' paths of the runtime, which set it
+ * in the thread with a BDAAllocSiteMark, so other allocations never look it up.
  */
 class KlassRegionMap : public CHeapObj<mtGC> {
 
  private:
-  static volatile bdareg_t _next_region;
+  // the space id of the last region given to a klass or site
+  static int        _last_space_id;
   static BDARegion* _region_data;
   static int        _region_data_sz;
-  static KlassRegionHashtable* _region_map;
 
   // parse the command line string BDAKlasses="..."
   static void parse_from_string(const char* line, void (*parse)(char*));
   static void parse_from_line(char* line);
+  // the container region of the next space
+  static bdareg_t next_region();
+  // the region for a bdareg_t value, or no_region_ptr() for the no_region
+  static BDARegion* region_ptr(bdareg_t r);
 
-  // Class that wraps the class names and the ids with they are promoted
+  // Class that wraps the class names and the ids with they are promoted. For
+  // allocation sites the class name is the holder of the method.
   class KlassRegionEl : public CHeapObj<mtGC> {
 
    private:
     const char*      _klass_name;
     const bdareg_t   _region_id;
+    const char*      _method_name;
+    const int        _bci;
    public:
     KlassRegionEl(const char* klass_name, bdareg_t region_id) :
-      _klass_name(klass_name), _region_id(region_id) {}
-
-    const char*      klass_name() const { return _klass_name; }
-    const bdareg_t   region_id()  const { return _region_id; }
+      _klass_name(klass_name), _region_id(region_id), _method_name(NULL), _bci(-1) {}
+    KlassRegionEl(const char* klass_name, bdareg_t region_id, const char* method_name, int bci) :
+      _klass_name(klass_name), _region_id(region_id), _method_name(method_name), _bci(bci) {}
+
+    const char*      klass_name()  const { return _klass_name; }
+    const bdareg_t   region_id()   const { return _region_id; }
+    const char*      method_name() const { return _method_name; }
+    int              bci()         const { return _bci; }
+    bool             is_excluded() const { return _region_id == BDARegion::no_region; }
     // routine to find the element with a specific char* value
     static bool equals_name(void* klass_name, KlassRegionEl* value) {
         return strcmp((char*)klass_name, value->klass_name()) == 0;
@@ -81,36 +62,65 @@ class KlassRegionMap : public CHeapObj<mtGC> {
 
  public:
   static GrowableArray<KlassRegionEl*>* _bda_class_names;
+  static GrowableArray<KlassRegionEl*>* _bda_site_names;
+  // the names of the klasses allocated at the sites resolved so far, NULL terminated.
+  // Classes are parsed in parallel, so it is replaced by a longer copy under
+  // BDASiteKlasses_lock and read without it. The copies it replaces are not freed,
+  // since a reader may still use them; there are as many as klasses named by sites.
+  static Symbol* const* volatile        _bda_site_klasses;
 
   static int number_bdaregions();
+  // true if BDAKlasses names any allocation site
+  static bool has_alloc_sites() {
+    return _bda_site_names != NULL && _bda_site_names->length() > 0;
+  }
 
   KlassRegionMap();
   ~KlassRegionMap();
 
   // checks if a klass is bda type and returns the appropriate region id
-  static BDARegion * is_bda_klass(Klass* k);
-  // Assembler version of is_bda_klass(Klass*)
-  static void        is_bda_klass_asm(JavaThread * java_thread, Klass* k);
-  // checks if a klass with "name" is a bda type
-  bool     is_bda_type(const char* name);
-  // actually gets the region id on where objects familiar to "name" live
-  BDARegion * bda_type(Klass* k);
-  // adds an antry to the Hashtable of klass_ptr<->bdareg_t
+  static BDARegion * is_bda_klass(Klass* k) { return k->bda_region(); }
+  // gets the region on where objects familiar to "name" live, or NULL if
+  // "name" is not a bda type
+  BDARegion * bda_type(const char* name);
+  // resolves the region of a newly parsed klass and saves it in the klass, and
+  // the regions of the allocation sites of its methods
   void add_entry(Klass* k);
+  // saves the regions of the allocation sites held by a newly parsed klass
+  void add_site_entries(Klass* k);
   // adds an entry for the general object space
   inline void add_other_entry(Klass* k);
   // adds an entry for one of the bda spaces
   inline void add_region_entry(Klass* k, BDARegion* r);
-  // an accessor for the region_map which is used by set_klass(k) to assign a bda space
-  static BDARegion* region_for_klass(Klass* k);
+  // the region where objects of the klass live, i.e., region_start for non-bda klasses
+  static BDARegion* region_for_klass(Klass* k) {
+    BDARegion* r = k->bda_region();
+    return r != NULL ? r : region_start_ptr();
+  }
+  // the region of an object allocated at a site: the one of the site, if it has one,
+  // or else the one of its klass. NULL means the object is not a container.
+  static BDARegion* region_for_site(BDARegion* klass_region, BDARegion* site_region) {
+    if (site_region == NULL) return klass_region;
+    return site_region != no_region_ptr() ? site_region : NULL;
+  }
+  // true if k is allocated at some site, i.e., the compiled 'new' paths of the runtime
+  // must look up the site of their caller
+  static bool is_site_klass(Klass* k);
+  // adds the name of a klass allocated at a site, unless it is known already
+  static void add_site_klass(Symbol* name);
+  // the region of the site of the 'new' in the last Java frame of thread, or NULL if
+  // it is not a site. Only used by the compiled 'new' paths, whose caller is compiled.
+  static BDARegion* site_region_of_caller(JavaThread* thread);
   // an accessor for the _region_data array which saves the bdareg_t wrapper
   static BDARegion* region_data() { return _region_data; }
   // an accessor for the elements in the _region_data array
   static BDARegion* region_elem(bdareg_t r) {
-    int idx = 0;
-    while(_region_data[idx].value() != r)
-      ++idx;
-    return &_region_data[idx];
+    assert((int)r < _region_data_sz, "not a region");
+    return &_region_data[r];
+  }
+  // the container region of a space, i.e., region_start for the general object space
+  static BDARegion* region_for_space(int space_id) {
+    return region_elem(BDARegion::container_of_space(space_id));
   }
   // Fast accessor for no_region and the low_addr of the _region_data array
   static BDARegion* no_region_ptr() { return &_region_data[0]; }
@@ -124,7 +134,7 @@ class KlassRegionMap : public CHeapObj<mtGC> {
 // Inline definition
 inline void
 KlassRegionMap::add_other_entry(Klass* k) {
-  _region_map->add_entry(k, region_start_ptr());
+  assert(k->bda_region() == NULL, "the region of a klass is set only once");
   if (TraceBDAClassAssociation) {
     {
       ResourceMark rm;
@@ -138,7 +148,8 @@ KlassRegionMap::add_other_entry(Klass* k) {
 
 inline void
 KlassRegionMap::add_region_entry(Klass* k, BDARegion* r) {
-  _region_map->add_entry(k, r);
+  assert(k->bda_region() == NULL, "the region of a klass is set only once");
+  k->set_bda_region(r);
   if (TraceBDAClassAssociation) {
     {
       ResourceMark rm;
@@ -150,4 +161,18 @@ KlassRegionMap::add_region_entry(Klass* k, BDARegion* r) {
   }
 }
 
+// BDAAllocSiteMark passes the region of the allocation site of a 'new', as given by
+// Method::bda_region_at, to the allocation of the instance in the runtime (see
+// CollectedHeap::common_mem_allocate_init), which takes it from the thread.
+class BDAAllocSiteMark : public StackObj {
+ private:
+  Thread* _thread;
+
+ public:
+  BDAAllocSiteMark(Thread* thread, BDARegion* site_region) : _thread(thread) {
+    _thread->set_bda_site_region(site_region);
+  }
+  ~BDAAllocSiteMark() { _thread->set_bda_site_region(NULL); }
+};
+
 #endif // SHARE_VM_OOPS_KLASSREGIONMAP_HPP
@@ -96,6 +96,9 @@ Method::Method(ConstMethod* xconst, AccessFlags access_flags, int size) {
   set_method_data(NULL);
   clear_method_counters();
   set_vtable_index(Method::garbage_vtable_index);
+#if defined(BDA) || defined(BDA_INTERPRETER)
+  _bda_sites = NULL;
+#endif
 
   // Fix and bury in Method*
   set_interpreter_entry(NULL); // sets i2i entry and from_int
@@ -119,10 +122,36 @@ void Method::deallocate_contents(ClassLoaderData* loader_data) {
   set_method_data(NULL);
   MetadataFactory::free_metadata(loader_data, method_counters());
   clear_method_counters();
+#if defined(BDA) || defined(BDA_INTERPRETER)
+  if (_bda_sites != NULL) {
+    delete _bda_sites;
+    _bda_sites = NULL;
+  }
+#endif
   // The nmethod will be gone when we get here.
   if (code() != NULL) _code = NULL;
 }
 
+#if defined(BDA) || defined(BDA_INTERPRETER)
+void Method::add_bda_site(int bci, BDARegion* r) {
+  assert(bci >= 0 && bci < code_size(), "bci out of bounds");
+  if (_bda_sites == NULL) {
+    _bda_sites = new (ResourceObj::C_HEAP, mtGC) GrowableArray<BDAAllocSite>(2, true);
+  }
+  _bda_sites->append(BDAAllocSite(bci, r));
+}
+
+BDARegion* Method::bda_region_at(int bci) const {
+  if (_bda_sites == NULL) return NULL;
+  for (int i = 0; i < _bda_sites->length(); i++) {
+    if (_bda_sites->at(i).bci() == bci) {
+      return _bda_sites->at(i).region();
+    }
+  }
+  return NULL;
+}
+#endif // BDA || BDA_INTERPRETER
+
 address Method::get_i2c_entry() {
   assert(_adapter != NULL, "must have");
   return _adapter->get_i2c_entry();
@@ -37,6 +37,9 @@
 #include "oops/typeArrayOop.hpp"
 #include "utilities/accessFlags.hpp"
 #include "utilities/growableArray.hpp"
+#if defined(BDA) || defined(BDA_INTERPRETER)
+#include "bda/bdaGlobals.hpp"
+#endif
 
 // A Method* represents a Java method.
 //
@@ -135,6 +138,11 @@ class Method : public Metadata {
   // NULL only at safepoints (because of a de-opt).
   nmethod* volatile _code;                       // Points to the corresponding piece of native code
   volatile address           _from_interpreted_entry; // Cache of _code ? _adapter->i2c_entry() : _i2i_entry
+#if defined(BDA) || defined(BDA_INTERPRETER)
+  // The allocation sites of this method that have their own bda-region (see
+  // KlassRegionMap), or NULL. Set when the holder is parsed, never changes afterwards.
+  GrowableArray<BDAAllocSite>* _bda_sites;
+#endif
 
   // Constructor
   Method(ConstMethod* xconst, AccessFlags access_flags, int size);
@@ -369,6 +377,14 @@ class Method : public Metadata {
     return _method_counters;
   }
 
+#if defined(BDA) || defined(BDA_INTERPRETER)
+  // bda allocation sites
+  GrowableArray<BDAAllocSite>* bda_sites() const { return _bda_sites; }
+  void add_bda_site(int bci, BDARegion* r);
+  // the region given to the allocation site at bci, or NULL if it has none
+  BDARegion* bda_region_at(int bci) const;
+#endif // BDA || BDA_INTERPRETER
+
   void clear_method_counters() {
     _method_counters = NULL;
   }
@@ -663,6 +679,9 @@ class Method : public Metadata {
   static ByteSize method_counters_offset()       {
     return byte_offset_of(Method, _method_counters);
   }
+#if defined(BDA) || defined(BDA_INTERPRETER)
+  static ByteSize bda_sites_offset()             { return byte_offset_of(Method, _bda_sites); }
+#endif // BDA || BDA_INTERPRETER
 #ifndef PRODUCT
   static ByteSize compiled_invocation_counter_offset() { return byte_offset_of(Method, _compiled_invocation_count); }
 #endif // not PRODUCT
@@ -3809,6 +3809,23 @@ void GraphKit::write_barrier_post(Node* oop_store,
     __ storeCM(__ ctrl(), card_adr, zero, oop_store, adr_idx, bt, adr_type);
   }
 
+#ifdef BDA
+  CardTableModRefBS* ct = (CardTableModRefBS*)(Universe::heap()->barrier_set());
+  if (ct->bda_summary_base != NULL) {
+    // Dirty the bda summary entry of the card as well (see cardTableModRefBS.hpp).
+    // It is dirty whenever the card is, so with UseCondCardMark this is only reached
+    // for a clean card. The entry is tested first, for the same reason as the card:
+    // most stores hit a slot whose entry is dirty already.
+    Node* summary_offset = __ URShiftX( cast, __ ConI(CardTableModRefBS::bda_summary_shift) );
+    Node* summary_base = makecon(TypeRawPtr::make((address)ct->bda_summary_base));
+    Node* summary_adr = __ AddP(__ top(), summary_base, summary_offset );
+    Node* summary_val = __ load( __ ctrl(), summary_adr, TypeInt::BYTE, bt, adr_type);
+    __ if_then(summary_val, BoolTest::ne, zero); {
+      __ store(__ ctrl(), summary_adr, zero, bt, adr_type, MemNode::unordered);
+    } __ end_if();
+  }
+#endif // BDA
+
   if (UseCondCardMark) {
     __ end_if();
   }
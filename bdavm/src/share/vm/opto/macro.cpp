@@ -41,6 +41,11 @@
 #include "opto/subnode.hpp"
 #include "opto/type.hpp"
 #include "runtime/sharedRuntime.hpp"
+#if defined(BDA) || defined(BDA_INTERPRETER)
+#include "bda/bdaRootBuffer.hpp"
+#include "ci/ciInstanceKlass.hpp"
+#include "gc_interface/collectedHeap.hpp"
+#endif
 
 
 //
@@ -1104,6 +1109,87 @@ Node* PhaseMacroExpand::make_store(Node* ctl, Node* mem, Node* base, int offset,
   return mem;
 }
 
+#if defined(BDA) || defined(BDA_INTERPRETER)
+// Folds the bda-region of the allocated klass, which is NULL for non-bda
+// klasses. Returns false if the klass is not known at compile time (e.g.,
+// Object.clone or reflective allocation), in which case the region is unknown.
+bool PhaseMacroExpand::bda_region_of(Node* klass_node, BDARegion*& region) {
+  region = NULL;
+  const TypeKlassPtr* tklass = _igvn.type(klass_node)->isa_klassptr();
+  if (tklass == NULL || !tklass->klass_is_exact() || !tklass->klass()->is_loaded()) {
+    return false;
+  }
+  ciKlass* k = tklass->klass();
+  if (k->is_instance_klass()) {
+    region = k->as_instance_klass()->bda_region();
+  }
+  return true;
+}
+
+// Logs the newly allocated container in the thread's BDARootBuffer, in the
+// same way the interpreter does (see TemplateTable::_new). The entry is
+// appended inline while there is room in the buffer; otherwise the runtime
+// allocates or flushes the buffer with a leaf call.
+void PhaseMacroExpand::bda_enqueue_root(AllocateNode* alloc, BDARegion* region,
+                                        Node*& control, Node*& rawmem, Node* object) {
+  enum { has_room_path = 1, full_path = 2 };
+
+  BasicType index_bt = TypeX_X->basic_type();
+  assert(sizeof(size_t) == type2aelembytes(index_bt), "Loading BDARootBuffer::_index with wrong size.");
+
+  Node* thread = transform_later(new (C) ThreadLocalNode());
+  Node* index_adr = basic_plus_adr(top()/*not oop*/, thread,
+                                   in_bytes(JavaThread::bda_root_buffer_index_offset()));
+  Node* buffer_adr = basic_plus_adr(top()/*not oop*/, thread,
+                                    in_bytes(JavaThread::bda_root_buffer_buf_offset()));
+  Node* region_con = makecon(TypeRawPtr::make((address)region));
+
+  Node* index = make_load(control, rawmem, index_adr, 0, TypeX_X, index_bt);
+  Node* room_cmp = transform_later(new (C) CmpXNode(index, MakeConX(0)));
+  Node* room_bol = transform_later(new (C) BoolNode(room_cmp, BoolTest::ne));
+  IfNode* room_iff = new (C) IfNode(control, room_bol, PROB_LIKELY_MAG(3), COUNT_UNKNOWN);
+  transform_later(room_iff);
+
+  Node* result_region = new (C) RegionNode(3);
+  Node* result_phi_rawmem = new (C) PhiNode(result_region, Type::MEMORY, TypeRawPtr::BOTTOM);
+
+  // There is room in the buffer: log [object, region] and bump the index down.
+  Node* has_room = transform_later(new (C) IfTrueNode(room_iff));
+  Node* next_index = transform_later(new (C) SubXNode(index, MakeConX(BDARootBuffer::entry_size_in_bytes())));
+  Node* buffer = make_load(has_room, rawmem, buffer_adr, 0, TypeRawPtr::NOTNULL, T_ADDRESS);
+  Node* entry = basic_plus_adr(top()/*not oop*/, buffer, next_index);
+  Node* mem = make_store(has_room, rawmem, entry, 0, object, T_ADDRESS);
+  mem = make_store(has_room, mem, basic_plus_adr(top()/*not oop*/, entry, wordSize), 0,
+                   region_con, T_ADDRESS);
+  mem = make_store(has_room, mem, index_adr, 0, next_index, index_bt);
+  result_region->init_req(has_room_path, has_room);
+  result_phi_rawmem->init_req(has_room_path, mem);
+
+  // The buffer is full (or was never allocated): call into the runtime.
+  Node* full = transform_later(new (C) IfFalseNode(room_iff));
+  CallLeafNode* call = new (C) CallLeafNode(OptoRuntime::bda_enqueue_root_Type(),
+                                            CAST_FROM_FN_PTR(address, CollectedHeap::enqueue_asm),
+                                            "bda_enqueue_root",
+                                            TypeRawPtr::BOTTOM);
+  call->init_req(TypeFunc::Parms+0, thread);
+  call->init_req(TypeFunc::Parms+1, object);
+  call->init_req(TypeFunc::Parms+2, region_con);
+  call->init_req(TypeFunc::Control, full);
+  call->init_req(TypeFunc::I_O    , top()); // does no i/o
+  call->init_req(TypeFunc::Memory , rawmem);
+  call->init_req(TypeFunc::ReturnAdr, alloc->in(TypeFunc::ReturnAdr));
+  call->init_req(TypeFunc::FramePtr, alloc->in(TypeFunc::FramePtr));
+  transform_later(call);
+  Node* call_ctrl = transform_later(new (C) ProjNode(call, TypeFunc::Control));
+  Node* call_mem = transform_later(new (C) ProjNode(call, TypeFunc::Memory));
+  result_region->init_req(full_path, call_ctrl);
+  result_phi_rawmem->init_req(full_path, call_mem);
+
+  control = transform_later(result_region);
+  rawmem = transform_later(result_phi_rawmem);
+}
+#endif // BDA || BDA_INTERPRETER
+
 //=============================================================================
 //
 //                              A L L O C A T I O N
@@ -1201,6 +1287,21 @@ void PhaseMacroExpand::expand_allocate_common(
     initial_slow_test = NULL;
   }
 
+#if defined(BDA) || defined(BDA_INTERPRETER)
+  BDARegion* bda_region = NULL;
+  if (UseBDA && length == NULL && !bda_region_of(klass_node, bda_region)) {
+    // The klass is not a compile-time constant and may be a bda klass. Let the
+    // runtime decide, since it registers bda roots itself.
+    always_slow = true;
+    initial_slow_test = NULL;
+  } else if (UseBDA && length == NULL && alloc->jvms() != NULL) {
+    // The region of an allocation site overrides the one of the klass. The
+    // slow path looks it up itself, in the runtime.
+    JVMState* jvms = alloc->jvms();
+    bda_region = jvms->method()->bda_region_at(jvms->bci(), bda_region);
+  }
+#endif
+
 
   enum { too_big_or_final_path = 1, need_gc_path = 2 };
   Node *slow_region = NULL;
@@ -1460,6 +1561,15 @@ void PhaseMacroExpand::expand_allocate_common(
       transform_later(fast_oop_rawmem);
     }
 
+#if defined(BDA) || defined(BDA_INTERPRETER)
+    // The region of the klass is constant, so only allocations of bda klasses
+    // pay for the root registration. The slow path registers the root itself
+    // (see CollectedHeap::common_mem_allocate_init).
+    if (bda_region != NULL) {
+      bda_enqueue_root(alloc, bda_region, fast_oop_ctrl, fast_oop_rawmem, fast_oop);
+    }
+#endif
+
     // Plug in the successful fast-path into the result merge point
     result_region    ->init_req(fast_result_path, fast_oop_ctrl);
     result_phi_rawoop->init_req(fast_result_path, fast_oop);
@@ -114,6 +114,12 @@ private:
                           Node* klass_node, Node* length,
                           Node* size_in_bytes);
 
+#if defined(BDA) || defined(BDA_INTERPRETER)
+  bool bda_region_of(Node* klass_node, BDARegion*& region);
+  void bda_enqueue_root(AllocateNode* alloc, BDARegion* region,
+                        Node*& control, Node*& rawmem, Node* object);
+#endif
+
   Node* prefetch_allocation(Node* i_o,
                             Node*& needgc_false, Node*& contended_phi_rawmem,
                             Node* old_eden_top, Node* new_eden_top,
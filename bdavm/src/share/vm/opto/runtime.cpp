@@ -246,6 +246,11 @@ JRT_BLOCK_ENTRY(void, OptoRuntime::new_instance_C(Klass* klass, JavaThread* thre
   }
 
   if (klass != NULL) {
+#if defined(BDA) || defined(BDA_INTERPRETER)
+    // The caller is compiled, so its site is only looked up for the klasses of sites
+    BDAAllocSiteMark site_mark(thread, UseBDA && KlassRegionMap::is_site_klass(klass) ?
+                               KlassRegionMap::site_region_of_caller(thread) : NULL);
+#endif
     // Scavenge and allocate an instance.
     oop result = InstanceKlass::cast(klass)->allocate_instance(THREAD);
     thread->set_vm_result(result);
@@ -1333,6 +1338,25 @@ const TypeFunc *OptoRuntime::dtrace_object_alloc_Type() {
   return TypeFunc::make(domain,range);
 }
 
+#if defined(BDA) || defined(BDA_INTERPRETER)
+const TypeFunc *OptoRuntime::bda_enqueue_root_Type() {
+  // create input type (domain)
+  const Type **fields = TypeTuple::fields(3);
+  fields[TypeFunc::Parms+0] = TypeRawPtr::BOTTOM;    // Thread-local storage
+  fields[TypeFunc::Parms+1] = TypeInstPtr::NOTNULL;  // oop;    newly allocated container
+  fields[TypeFunc::Parms+2] = TypeRawPtr::BOTTOM;    // BDARegion* of its klass
+
+  const TypeTuple *domain = TypeTuple::make(TypeFunc::Parms+3,fields);
+
+  // create result type (range)
+  fields = TypeTuple::fields(0);
+
+  const TypeTuple *range = TypeTuple::make(TypeFunc::Parms+0,fields);
+
+  return TypeFunc::make(domain,range);
+}
+#endif // BDA || BDA_INTERPRETER
+
 
 JRT_ENTRY_NO_ASYNC(void, OptoRuntime::register_finalizer(oopDesc* obj, JavaThread* thread))
   assert(obj->is_oop(), "must be a valid oop");
@@ -327,6 +327,11 @@ private:
   static const TypeFunc* dtrace_method_entry_exit_Type();
   static const TypeFunc* dtrace_object_alloc_Type();
 
+#if defined(BDA) || defined(BDA_INTERPRETER)
+  // BDA support
+  static const TypeFunc* bda_enqueue_root_Type();
+#endif
+
 # ifdef ENABLE_ZAP_DEAD_LOCALS
   static const TypeFunc* zap_dead_locals_Type();
 # endif
@@ -3950,7 +3950,9 @@ class CommandLineFlags {
                "Use Big-data collections spaces")                           \
                                                                             \
   product(ccstrlist, BDAKlasses, "",                                        \
-               "The list of BDA Classes")                                   \
+               "The list of BDA Classes. Entries of the form "              \
+               "Holder::method@bci name allocation sites instead, and "     \
+               "!Holder::method@bci excludes a site")                       \
                                                                             \
   product(double, BDARatio, 5.0,                                            \
                "Ratio for the size of the BDSpaces on the heap, "           \
@@ -3977,7 +3979,55 @@ class CommandLineFlags {
                "for the calculation of the amount of data")                 \
                                                                             \
   product(uintx, BDAOldPLABSize, 512,                                       \
-               "The size of each BDA PLAB.")                                \
+               "The initial size of each BDA PLAB. It doubles on each "     \
+               "refill for the same container, up to 8 times this size")    \
+                                                                            \
+  product(uintx, BDAOldPLABCount, 4,                                        \
+               "Number of BDA PLABs of each gc thread, one for each of the "\
+               "last containers it promoted elements of")                   \
+                                                                            \
+  product(uintx, BDARootBufferSize, 256,                                    \
+               "Number of bda roots in each thread-local buffer, which is " \
+               "handed as a whole to the refqueue when full")               \
+                                                                            \
+  product(uintx, BDARefRootsBatchSize, 64,                                  \
+               "Number of bda roots claimed at once by each gc thread "     \
+               "while scanning the refqueue")                               \
+                                                                            \
+  product(uintx, BDAOldToYoungChunkSize, 256,                               \
+               "Number of cards of a bda segment claimed at once by each "  \
+               "gc thread while scanning for old-to-young refs")            \
+                                                                            \
+  product(bool, BDANUMAPlacement, false,                                    \
+               "Place the segments of each container on the NUMA node of "  \
+               "the thread that allocated its root. Requires UseNUMA")      \
+                                                                            \
+  product(uintx, BDASegmentCacheSize, 4,                                    \
+               "Number of segments each gc thread reserves at once in a "   \
+               "bda-space during promotion")                                \
+                                                                            \
+  product(bool, BDAAdaptiveSegmentSize, true,                               \
+               "Adapt the segment size of each bda-space to the growth of " \
+               "its containers, and grow the segments of large containers " \
+               "geometrically")                                             \
+                                                                            \
+  product(bool, BDAAdaptiveSpaceLayout, true,                               \
+               "Move the boundaries between the bda-spaces at the end of "  \
+               "each scavenge, so that each one has room for the words it " \
+               "is expected to promote until the next one")                 \
+                                                                            \
+  product(bool, BDADefragmentAtFullGC, false,                               \
+               "Rewrite the segments of each container of a fragmented "    \
+               "bda-space into a contiguous run at full GC")                \
+                                                                            \
+  product(uintx, BDADefragmentThreshold, 30,                                \
+               "Average fragmentation (in percent) of the segments of a "   \
+               "bda-space above which it is defragmented at full GC")       \
+                                                                            \
+  product(uintx, BDAThreshold, 0,                                           \
+               "Percentage of the objects of an old region, reached from "  \
+               "the containers of one bda-space, above which the region "   \
+               "is moved into that bda-space at full GC. 0 disables it")    \
                                                                             \
   product(bool, TraceBDAClassAssociation, false,                            \
                "Traces the association between bda-region value and "       \
@@ -125,6 +125,9 @@ Monitor* GCTaskManager_lock           = NULL;
 Mutex*   Management_lock              = NULL;
 Monitor* Service_lock                 = NULL;
 Monitor* PeriodicTask_lock            = NULL;
+#ifdef BDA
+Mutex*   BDASiteKlasses_lock          = NULL;
+#endif
 
 #ifdef INCLUDE_TRACE
 Mutex*   JfrStacktrace_lock           = NULL;
@@ -221,6 +224,9 @@ void mutex_init() {
   def(InlineCacheBuffer_lock       , Mutex  , leaf,        true );
   def(VMStatistic_lock             , Mutex  , leaf,        false);
   def(ExpandHeap_lock              , Mutex  , leaf,        true ); // Used during compilation by VM thread
+#ifdef BDA
+  def(BDASiteKlasses_lock          , Mutex  , leaf,        true ); // publishes the klasses of the bda allocation sites
+#endif
   def(JNIHandleBlockFreeList_lock  , Mutex  , leaf,        true ); // handles are used by VM thread
   def(SignatureHandlerLibrary_lock , Mutex  , leaf,        false);
   def(SymbolTable_lock             , Mutex  , leaf+2,      true );
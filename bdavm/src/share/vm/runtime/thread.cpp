@@ -220,6 +220,7 @@ Thread::Thread() {
   set_stack_size(0);
   set_self_raw_id(0);
   set_lgrp_id(-1);
+  set_bda_site_region(NULL);
 
   // allocated data structures
   set_osthread(NULL);
@@ -1925,6 +1926,12 @@ void JavaThread::exit(bool destroy_vm, ExitType exit_type) {
   }
 #endif // INCLUDE_ALL_GCS
 
+#if defined(BDA) || defined(BDA_INTERPRETER)
+  // The roots logged by this thread must reach the refqueue, or the containers
+  // it allocated would not be placed in their bda-spaces.
+  bda_root_buffer().flush();
+#endif // BDA || BDA_INTERPRETER
+
   // Remove from list of active threads list, and notify VM thread if we are the last non-daemon thread
   Threads::remove(this);
 }
@@ -59,6 +59,9 @@
 
 // Big data allocators support
 #include "bda/bdaGlobals.hpp"
+#if defined(BDA) || defined(BDA_INTERPRETER)
+#include "bda/bdaRootBuffer.hpp"
+#endif // BDA || BDA_INTERPRETER
 
 class ThreadSafepointState;
 class ThreadProfiler;
@@ -550,6 +553,9 @@ protected:
 
   // Support for big data collections
   BDARegion* _alloc_region;
+  // The region of the allocation site of the 'new' being run by the runtime, if any
+  // (see BDAAllocSiteMark)
+  BDARegion* _bda_site_region;
 
  public:
   // Stack overflow support
@@ -576,6 +582,8 @@ protected:
   // to the values specified in the BDACollectionType enum
   BDARegion* alloc_region() const { return _alloc_region; }
   void set_alloc_region(BDARegion* region) { _alloc_region = region; }
+  BDARegion* bda_site_region() const { return _bda_site_region; }
+  void set_bda_site_region(BDARegion* region) { _bda_site_region = region; }
 
   // Printing
   void print_on(outputStream* st) const;
@@ -979,6 +987,11 @@ class JavaThread: public Thread {
   void flush_barrier_queues();
 #endif // INCLUDE_ALL_GCS
 
+#if defined(BDA) || defined(BDA_INTERPRETER)
+  // Thread-local log of newly allocated bda roots (see bdaRootBuffer.hpp).
+  BDARootBuffer _bda_root_buffer;
+#endif // BDA || BDA_INTERPRETER
+
   friend class VMThread;
   friend class ThreadWaitTransition;
   friend class VM_Exit;
@@ -1394,6 +1407,14 @@ class JavaThread: public Thread {
   static ByteSize satb_mark_queue_offset()       { return byte_offset_of(JavaThread, _satb_mark_queue); }
   static ByteSize dirty_card_queue_offset()      { return byte_offset_of(JavaThread, _dirty_card_queue); }
 #endif // INCLUDE_ALL_GCS
+#if defined(BDA) || defined(BDA_INTERPRETER)
+  static ByteSize bda_root_buffer_buf_offset() {
+    return byte_offset_of(JavaThread, _bda_root_buffer) + BDARootBuffer::byte_offset_of_buf();
+  }
+  static ByteSize bda_root_buffer_index_offset() {
+    return byte_offset_of(JavaThread, _bda_root_buffer) + BDARootBuffer::byte_offset_of_index();
+  }
+#endif // BDA || BDA_INTERPRETER
 
   // Returns the jni environment for this thread
   JNIEnv* jni_environment()                      { return &_jni_environment; }
@@ -1693,6 +1714,11 @@ public:
   }
 #endif // INCLUDE_ALL_GCS
 
+#if defined(BDA) || defined(BDA_INTERPRETER)
+  // Big data allocators root buffer support
+  BDARootBuffer& bda_root_buffer() { return _bda_root_buffer; }
+#endif // BDA || BDA_INTERPRETER
+
   // This method initializes the SATB and dirty card queues before a
   // JavaThread is added to the Java thread list. Right now, we don't
   // have to do anything to the dirty card queue (it should have been
@@ -31,6 +31,9 @@
 #include "services/heapDumper.hpp"
 #include "services/management.hpp"
 #include "utilities/macros.hpp"
+#ifdef BDA
+#include "bda/bdaHistogram.hpp"
+#endif
 
 PRAGMA_FORMAT_MUTE_WARNINGS_FOR_GCC
 
@@ -53,6 +56,9 @@ void DCmdRegistrant::register_dcmds(){
   DCmdFactory::register_DCmdFactory(new DCmdFactoryImpl<HeapDumpDCmd>(DCmd_Source_Internal | DCmd_Source_AttachAPI, true, false));
   DCmdFactory::register_DCmdFactory(new DCmdFactoryImpl<ClassHistogramDCmd>(full_export, true, false));
   DCmdFactory::register_DCmdFactory(new DCmdFactoryImpl<ClassStatsDCmd>(full_export, true, false));
+#ifdef BDA
+  DCmdFactory::register_DCmdFactory(new DCmdFactoryImpl<BDAHistogramDCmd>(full_export, true, false));
+#endif // BDA
 #endif // INCLUDE_SERVICES
   DCmdFactory::register_DCmdFactory(new DCmdFactoryImpl<ThreadDumpDCmd>(full_export, true, false));
   DCmdFactory::register_DCmdFactory(new DCmdFactoryImpl<RotateGCLogDCmd>(full_export, true, false));
@@ -338,6 +344,39 @@ int ClassHistogramDCmd::num_arguments() {
   }
 }
 
+#ifdef BDA
+BDAHistogramDCmd::BDAHistogramDCmd(outputStream* output, bool heap) :
+                                   DCmdWithParser(output, heap),
+  _top("top", "Number of containers retaining the most bytes to show, at most 10000",
+       "INT", false, "10") {
+  _dcmdparser.add_dcmd_argument(&_top);
+}
+
+void BDAHistogramDCmd::execute(DCmdSource source, TRAPS) {
+  if (!UseBDA) {
+    output()->print_cr("GC.bda_histogram requires -XX:+UseBDA");
+    return;
+  }
+  if (_top.value() < 0 || _top.value() > max_top) {
+    output()->print_cr("The number of containers must be between 0 and %d", (int)max_top);
+    return;
+  }
+  VM_BDAHistogram heapop(output(), (uint)_top.value());
+  VMThread::execute(&heapop);
+}
+
+int BDAHistogramDCmd::num_arguments() {
+  ResourceMark rm;
+  BDAHistogramDCmd* dcmd = new BDAHistogramDCmd(NULL, false);
+  if (dcmd != NULL) {
+    DCmdMark mark(dcmd);
+    return dcmd->_dcmdparser.num_arguments();
+  } else {
+    return 0;
+  }
+}
+#endif // BDA
+
 #define DEFAULT_COLUMNS "InstBytes,KlassBytes,CpAll,annotations,MethodCount,Bytecodes,MethodAll,ROAll,RWAll,Total"
 ClassStatsDCmd::ClassStatsDCmd(outputStream* output, bool heap) :
                                        DCmdWithParser(output, heap),
@@ -228,6 +228,34 @@ public:
   virtual void execute(DCmdSource source, TRAPS);
 };
 
+#ifdef BDA
+class BDAHistogramDCmd : public DCmdWithParser {
+protected:
+  DCmdArgument<jlong> _top;
+public:
+  // The most containers that may be asked for
+  enum { max_top = 10000 };
+  BDAHistogramDCmd(outputStream* output, bool heap);
+  static const char* name() {
+    return "GC.bda_histogram";
+  }
+  static const char* description() {
+    return "Provide statistics about the footprint of the bda-spaces and their "
+           "largest containers.";
+  }
+  static const char* impact() {
+    return "Medium: Depends on the number of container segments.";
+  }
+  static const JavaPermission permission() {
+    JavaPermission p = {"java.lang.management.ManagementPermission",
+                        "monitor", NULL};
+    return p;
+  }
+  static int num_arguments();
+  virtual void execute(DCmdSource source, TRAPS);
+};
+#endif // BDA
+
 class ClassStatsDCmd : public DCmdWithParser {
 protected:
   DCmdArgument<bool> _all;
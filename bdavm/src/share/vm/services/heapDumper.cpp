@@ -44,6 +44,10 @@
 #if INCLUDE_ALL_GCS
 #include "gc_implementation/parallelScavenge/parallelScavengeHeap.hpp"
 #endif // INCLUDE_ALL_GCS
+#ifdef BDA
+#include "bda/mutableBDASpace.hpp"
+#include "gc_implementation/parallelScavenge/psOldGen.hpp"
+#endif // BDA
 
 /*
  * HPROF binary format - description copied from:
@@ -309,6 +313,19 @@
  *
  * HPROF_HEAP_DUMP_END      denotes the end of a heap dump
  *
+ *
+ * With -XX:+UseBDA the dump also tells the container of each segment of
+ * the old generation, whose objects are the ones between the start and the
+ * top of the segment. Parsers that do not know the tag may skip the records
+ * by their length.
+ *
+ * HPROF_BDA_CONTAINERS     the segments of the containers
+ *
+ *               [id        container id (the start of its first segment)
+ *                id        segment start
+ *                id        segment top
+ *                u2]*      space id (0 is the general object space)
+ *
  */
 
 
@@ -333,6 +350,9 @@ typedef enum {
   HPROF_HEAP_DUMP_SEGMENT       = 0x1C,
   HPROF_HEAP_DUMP_END           = 0x2C,
 
+  // BDA record types
+  HPROF_BDA_CONTAINERS          = 0xB0,
+
   // field types
   HPROF_ARRAY_OBJECT            = 0x01,
   HPROF_NORMAL_OBJECT           = 0x02,
@@ -1362,6 +1382,11 @@ class VM_HeapDumper : public VM_GC_Operation {
   // HPROF_TRACE and HPROF_FRAME records
   void dump_stack_traces();
 
+#ifdef BDA
+  // HPROF_BDA_CONTAINERS records
+  void dump_bda_containers();
+#endif
+
   // writes a HPROF_HEAP_DUMP or HPROF_HEAP_DUMP_SEGMENT record
   void write_dump_header();
 
@@ -1731,6 +1756,13 @@ void VM_HeapDumper::doit() {
   // this must be called after _klass_map is built when iterating the classes above.
   dump_stack_traces();
 
+#ifdef BDA
+  // write HPROF_BDA_CONTAINERS records
+  if (UseBDA) {
+    dump_bda_containers();
+  }
+#endif
+
   // write HPROF_HEAP_DUMP or HPROF_HEAP_DUMP_SEGMENT
   write_dump_header();
 
@@ -1775,6 +1807,48 @@ void VM_HeapDumper::doit() {
   clear_global_writer();
 }
 
+#ifdef BDA
+void VM_HeapDumper::dump_bda_containers() {
+  MutableBDASpace* bda_space = ((ParallelScavengeHeap*)Universe::heap())->old_gen()->bda_space();
+  GrowableArray<MutableBDASpace::CGRPSpace*>* spaces = bda_space->spaces();
+  const u4 entry_size = 3 * oopSize + 2;
+  // a record is split when its length would not fit in a u4
+  const size_t max_entries = max_juint / entry_size;
+
+  // the segments are written by container, from the space of its first one,
+  // since the segments of a container may be in different spaces
+  for (int i = 0; i < spaces->length(); i++) {
+    MutableBDASpace::CGRPSpace* grp = spaces->at(i);
+    size_t total = 0;
+    for (GenQueueIterator<container_t, mtGC> it = grp->containers_iterator(); *it != NULL; ++it) {
+      container_t c = *it;
+      if (c->_prev_segment != NULL) continue;
+      for (container_t seg = c; seg != NULL; seg = seg->_next_segment) {
+        total++;
+      }
+    }
+
+    size_t left = 0;
+    for (GenQueueIterator<container_t, mtGC> it = grp->containers_iterator(); *it != NULL; ++it) {
+      container_t c = *it;
+      if (c->_prev_segment != NULL) continue;
+      for (container_t seg = c; seg != NULL; seg = seg->_next_segment) {
+        if (left == 0) {
+          left = MIN2(total, max_entries);
+          total -= left;
+          DumperSupport::write_header(writer(), HPROF_BDA_CONTAINERS, (u4)(left * entry_size));
+        }
+        writer()->write_objectID(oop(c->_start));
+        writer()->write_objectID(oop(seg->_start));
+        writer()->write_objectID(oop(seg->_top));
+        writer()->write_u2((u2)seg->_space_id);
+        left--;
+      }
+    }
+  }
+}
+#endif // BDA
+
 void VM_HeapDumper::dump_stack_traces() {
   // write a HPROF_TRACE record without any frames to be referenced as object alloc sites
   DumperSupport::write_header(writer(), HPROF_TRACE, 3*sizeof(u4));
@@ -363,6 +363,28 @@ void MemoryService::add_psOld_memory_pool(PSOldGen* gen, MemoryManager* mgr) {
                                                    true /* support_usage_threshold */);
   mgr->add_pool(old_gen);
   _pools_list->append(old_gen);
+
+#ifdef BDA
+  // Break down the old gen in the bda-spaces, the general object space first
+  if (UseBDA) {
+    GrowableArray<MutableBDASpace::CGRPSpace*>* spaces = gen->bda_space()->spaces();
+    for (int i = 0; i < spaces->length(); i++) {
+      char name[32];
+      if (i == 0) {
+        jio_snprintf(name, sizeof(name), "PS BDA General Space");
+      } else {
+        jio_snprintf(name, sizeof(name), "PS BDA Space %d", i);
+      }
+      BDASpacePool* bda_space = new BDASpacePool(gen,
+                                                 spaces->at(i),
+                                                 os::strdup(name, mtGC),
+                                                 MemoryPool::Heap,
+                                                 true /* support_usage_threshold */);
+      mgr->add_pool(bda_space);
+      _pools_list->append(bda_space);
+    }
+  }
+#endif // BDA
 }
 
 void MemoryService::add_g1YoungGen_memory_pool(G1CollectedHeap* g1h,
@@ -94,3 +94,24 @@ MemoryUsage SurvivorMutableSpacePool::get_memory_usage() {
   size_t committed = committed_in_bytes();
   return MemoryUsage(initial_size(), used, committed, maxSize);
 }
+
+#ifdef BDA
+BDASpacePool::BDASpacePool(PSOldGen* gen,
+                           MutableBDASpace::CGRPSpace* grp,
+                           const char* name,
+                           PoolType type,
+                           bool support_usage_threshold) :
+  // A space may grow over the whole old gen
+  CollectedMemoryPool(name, type, grp->space()->capacity_in_bytes(),
+                      gen->reserved().byte_size(), support_usage_threshold),
+  _grp(grp) {
+}
+
+MemoryUsage BDASpacePool::get_memory_usage() {
+  size_t maxSize   = (available_for_allocation() ? max_size() : 0);
+  size_t used      = used_in_bytes();
+  size_t committed = committed_in_bytes();
+
+  return MemoryUsage(initial_size(), used, committed, maxSize);
+}
+#endif // BDA
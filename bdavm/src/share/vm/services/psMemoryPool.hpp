@@ -35,6 +35,9 @@
 #include "memory/space.hpp"
 #include "services/memoryPool.hpp"
 #include "services/memoryUsage.hpp"
+#ifdef BDA
+#include "bda/mutableBDASpace.hpp"
+#endif // BDA
 #endif // INCLUDE_ALL_GCS
 
 class PSGenerationPool : public CollectedMemoryPool {
@@ -94,4 +97,28 @@ public:
   }
 };
 
+#ifdef BDA
+// One pool for each bda-space of the old gen. The spaces share the memory of the
+// old gen and their boundaries move with the layout of the bda-spaces, so the pools
+// are only reported by the major manager along with the "PS Old Gen" pool, whose
+// usage they break down.
+class BDASpacePool : public CollectedMemoryPool {
+private:
+  MutableBDASpace::CGRPSpace* _grp;
+
+public:
+  BDASpacePool(PSOldGen* gen,
+               MutableBDASpace::CGRPSpace* grp,
+               const char* name,
+               PoolType type,
+               bool support_usage_threshold);
+
+  MemoryUsage get_memory_usage();
+  // The words taken by the segments of the space, which need no walk of the containers.
+  // The spill and the runs cached by the gc threads are free, although below the top.
+  size_t used_in_bytes()              { return _grp->reserved_words() * HeapWordSize; }
+  size_t committed_in_bytes()         { return _grp->space()->capacity_in_bytes(); }
+};
+#endif // BDA
+
 #endif // SHARE_VM_SERVICES_PSMEMORYPOOL_HPP
@@ -757,32 +757,57 @@ class StarTask {
 class ObjArrayTask
 {
 public:
-  ObjArrayTask(oop o = NULL, int idx = 0): _obj(o), _index(idx) { }
+  ObjArrayTask(oop o = NULL, int idx = 0): _obj(o), _index(idx) {
+#ifdef BDA
+    _owner = 0;
+#endif
+  }
   ObjArrayTask(oop o, size_t idx): _obj(o), _index(int(idx)) {
     assert(idx <= size_t(max_jint), "too big");
+#ifdef BDA
+    _owner = 0;
+#endif
+  }
+  ObjArrayTask(const ObjArrayTask& t): _obj(t._obj), _index(t._index) {
+#ifdef BDA
+    _owner = t._owner;
+#endif
   }
-  ObjArrayTask(const ObjArrayTask& t): _obj(t._obj), _index(t._index) { }
 
   ObjArrayTask& operator =(const ObjArrayTask& t) {
     _obj = t._obj;
     _index = t._index;
+#ifdef BDA
+    _owner = t._owner;
+#endif
     return *this;
   }
   volatile ObjArrayTask&
   operator =(const volatile ObjArrayTask& t) volatile {
     (void)const_cast<oop&>(_obj = t._obj);
     _index = t._index;
+#ifdef BDA
+    _owner = t._owner;
+#endif
     return *this;
   }
 
   inline oop obj()   const { return _obj; }
   inline int index() const { return _index; }
+#ifdef BDA
+  // The bda-space that reached the array (see BDAMarkTask)
+  inline int  owner() const      { return _owner; }
+  inline void set_owner(int o)   { _owner = o; }
+#endif
 
   DEBUG_ONLY(bool is_valid() const); // Tasks to be pushed/popped must be valid.
 
 private:
   oop _obj;
   int _index;
+#ifdef BDA
+  int _owner;
+#endif
 };
 
 #ifdef BDA
@@ -830,6 +855,37 @@ class BDARefTask
     return (((uintptr_t)_holder & COMPRESSED_OOP_MASK) != 0);
   }
 };
+
+//
+// BDAMarkTask is the element of the marking stacks of the ParallelCompact collector. It
+// groups the oop with the bda-space whose containers reached it, so that the objects it
+// reaches in turn are counted for the same bda-space (see BDADataCounters), however deep
+// they are below the container.
+//
+class BDAMarkTask
+{
+  oop _obj;
+  int _owner;
+
+ public:
+
+  BDAMarkTask(oop o = NULL, int owner = 0) : _obj(o), _owner(owner) { }
+  BDAMarkTask(const BDAMarkTask& t) : _obj(t._obj), _owner(t._owner) { }
+
+  BDAMarkTask& operator=(const BDAMarkTask& t) {
+    _obj = t._obj;
+    _owner = t._owner;
+    return *this;
+  }
+  volatile BDAMarkTask& operator=(const volatile BDAMarkTask& t) volatile {
+    (void)const_cast<oop&>(_obj = t._obj);
+    _owner = t._owner;
+    return *this;
+  }
+
+  oop obj()   const { return _obj; }
+  int owner() const { return _owner; }
+};
 #endif // BDA
 
 #ifdef _MSC_VER